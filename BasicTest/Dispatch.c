@@ -0,0 +1,506 @@
+/**
+ * @file Dispatch.c
+ * @brief This file contains sources about the dispatch of the commands received from the drone
+ * @date 19/10/2026
+ *
+ * In DISPATCH_MODE_ASYNC, the thread receiving the commands only copies the arguments in a bounded
+ * queue allocated at init ; slow callbacks (ncurses drawing, files) are run by the worker threads.
+ */
+
+/*****************************************
+ *
+ *             include file :
+ *
+ *****************************************/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <libARSAL/ARSAL.h>
+#include <libARController/ARController.h>
+
+#include "Dispatch.h"
+
+/*****************************************
+ *
+ *             define :
+ *
+ *****************************************/
+#define TAG "Dispatch"
+
+#define DISPATCH_NO_SLOT -1
+
+/*****************************************
+ *
+ *             private header:
+ *
+ ****************************************/
+
+static void DISPATCH_BuildEvent (DISPATCH_Event_t *event, eARCONTROLLER_DICTIONARY_KEY commandKey, int isList, ARCONTROLLER_DICTIONARY_ELEMENT_t *element);
+static void DISPATCH_CopyEvent (DISPATCH_Event_t *dst, const DISPATCH_Event_t *src);
+static void DISPATCH_Enqueue (const DISPATCH_Event_t *event);
+static void *DISPATCH_WorkerRun (void *data);
+static eARCONTROLLER_ERROR DISPATCH_SetFeatureCallback (ARCONTROLLER_Device_t *deviceController, eARCONTROLLER_DICTIONARY_KEY commandKey, ARCONTROLLER_DICTIONARY_CALLBACK_t callback, void *customData, int add);
+
+/*****************************************
+ *
+ *             implementation :
+ *
+ *****************************************/
+
+static eDISPATCH_MODE dispatchMode = DISPATCH_MODE_INLINE;
+static DISPATCH_Callback_t dispatchCallback = NULL;
+static void *dispatchCustomData = NULL;
+
+static ARSAL_Mutex_t queueMutex;
+static ARSAL_Cond_t queueCond;
+static int queueLockInitialized = 0;
+static DISPATCH_Event_t *eventQueue = NULL;
+static int eventQueueSize = 0;
+static int eventQueueHead = 0;
+static int eventQueueCount = 0;
+static int eventQueueRun = 0;
+static int pendingSlot[ARCONTROLLER_DICTIONARY_DICTIONARY_KEY_MAX]; // slot of the queued event of each non-list command
+static DISPATCH_Metrics_t dispatchMetrics;
+
+static ARSAL_Thread_t *workerThreads = NULL;
+static int workerThreadCount = 0;
+
+int DISPATCH_Init (eDISPATCH_MODE mode, int workerCount, int queueSize, DISPATCH_Callback_t callback, void *customData)
+{
+    int failed = 0;
+    int i = 0;
+
+    if ((mode >= DISPATCH_MODE_MAX) || (callback == NULL))
+    {
+        return -1;
+    }
+
+    dispatchMode = mode;
+    dispatchCallback = callback;
+    dispatchCustomData = customData;
+    memset(&dispatchMetrics, 0, sizeof(dispatchMetrics));
+
+    if (dispatchMode == DISPATCH_MODE_INLINE)
+    {
+        return 0;
+    }
+
+    if ((workerCount <= 0) || (queueSize <= 0))
+    {
+        return -1;
+    }
+
+    for (i = 0; i < ARCONTROLLER_DICTIONARY_DICTIONARY_KEY_MAX; i++)
+    {
+        pendingSlot[i] = DISPATCH_NO_SLOT;
+    }
+
+    if (ARSAL_Mutex_Init(&queueMutex) != 0)
+    {
+        DISPATCH_Destroy();
+        return -1;
+    }
+    if (ARSAL_Cond_Init(&queueCond) != 0)
+    {
+        ARSAL_Mutex_Destroy(&queueMutex);
+        DISPATCH_Destroy();
+        return -1;
+    }
+    queueLockInitialized = 1;
+
+    eventQueue = calloc(queueSize, sizeof(DISPATCH_Event_t));
+    workerThreads = calloc(workerCount, sizeof(ARSAL_Thread_t));
+    if ((eventQueue == NULL) || (workerThreads == NULL))
+    {
+        failed = 1;
+    }
+
+    if (!failed)
+    {
+        eventQueueSize = queueSize;
+        eventQueueHead = 0;
+        eventQueueCount = 0;
+        eventQueueRun = 1;
+
+        for (workerThreadCount = 0; workerThreadCount < workerCount; workerThreadCount++)
+        {
+            if (ARSAL_Thread_Create(&(workerThreads[workerThreadCount]), DISPATCH_WorkerRun, NULL) != 0)
+            {
+                ARSAL_PRINT(ARSAL_PRINT_ERROR, TAG, "Creation of worker %d failed.", workerThreadCount);
+                failed = 1;
+                break;
+            }
+        }
+    }
+
+    if (failed)
+    {
+        DISPATCH_Destroy();
+        return -1;
+    }
+
+    return 0;
+}
+
+void DISPATCH_Destroy (void)
+{
+    int i = 0;
+
+    if ((eventQueue != NULL) && (workerThreads != NULL))
+    {
+        ARSAL_Mutex_Lock(&queueMutex);
+        eventQueueRun = 0;
+        ARSAL_Cond_Broadcast(&queueCond);
+        ARSAL_Mutex_Unlock(&queueMutex);
+
+        for (i = 0; i < workerThreadCount; i++)
+        {
+            ARSAL_Thread_Join(workerThreads[i], NULL);
+            ARSAL_Thread_Destroy(&(workerThreads[i]));
+        }
+    }
+
+    if (queueLockInitialized)
+    {
+        ARSAL_Cond_Destroy(&queueCond);
+        ARSAL_Mutex_Destroy(&queueMutex);
+        queueLockInitialized = 0;
+    }
+
+    free(workerThreads);
+    workerThreads = NULL;
+    workerThreadCount = 0;
+    free(eventQueue);
+    eventQueue = NULL;
+    eventQueueSize = 0;
+    dispatchMode = DISPATCH_MODE_INLINE;
+    dispatchCallback = NULL;
+}
+
+void DISPATCH_Push (eARCONTROLLER_DICTIONARY_KEY commandKey, ARCONTROLLER_DICTIONARY_ELEMENT_t *elementDictionary)
+{
+    ARCONTROLLER_DICTIONARY_ELEMENT_t *singleElement = NULL;
+    ARCONTROLLER_DICTIONARY_ELEMENT_t *dictElement = NULL;
+    ARCONTROLLER_DICTIONARY_ELEMENT_t *dictTmp = NULL;
+    DISPATCH_Event_t event;
+
+    if ((dispatchCallback == NULL) || (elementDictionary == NULL))
+    {
+        return;
+    }
+
+    HASH_FIND_STR (elementDictionary, ARCONTROLLER_DICTIONARY_SINGLE_KEY, singleElement);
+
+    if (singleElement != NULL)
+    {
+        DISPATCH_BuildEvent(&event, commandKey, 0, singleElement);
+
+        if (dispatchMode == DISPATCH_MODE_INLINE)
+        {
+            dispatchCallback(&event, dispatchCustomData);
+            __atomic_add_fetch(&(dispatchMetrics.processed), 1, __ATOMIC_RELAXED);
+        }
+        else
+        {
+            DISPATCH_Enqueue(&event);
+        }
+    }
+    else
+    {
+        HASH_ITER(hh, elementDictionary, dictElement, dictTmp)
+        {
+            DISPATCH_BuildEvent(&event, commandKey, 1, dictElement);
+
+            if (dispatchMode == DISPATCH_MODE_INLINE)
+            {
+                dispatchCallback(&event, dispatchCustomData);
+                __atomic_add_fetch(&(dispatchMetrics.processed), 1, __ATOMIC_RELAXED);
+            }
+            else
+            {
+                DISPATCH_Enqueue(&event);
+            }
+        }
+    }
+}
+
+eARCONTROLLER_ERROR DISPATCH_Subscribe (ARCONTROLLER_Device_t *deviceController, const eARCONTROLLER_DICTIONARY_KEY *commandKeys, int commandCount, ARCONTROLLER_DICTIONARY_CALLBACK_t callback, void *customData)
+{
+    eARCONTROLLER_ERROR error = ARCONTROLLER_OK;
+    int i = 0;
+
+    if ((deviceController == NULL) || (commandKeys == NULL) || (callback == NULL))
+    {
+        return ARCONTROLLER_ERROR_BAD_PARAMETER;
+    }
+
+    for (i = 0; (i < commandCount) && (error == ARCONTROLLER_OK); i++)
+    {
+        error = DISPATCH_SetFeatureCallback(deviceController, commandKeys[i], callback, customData, 1);
+        if (error != ARCONTROLLER_OK)
+        {
+            ARSAL_PRINT(ARSAL_PRINT_ERROR, TAG, "Subscription to command %d failed: %s", commandKeys[i], ARCONTROLLER_Error_ToString(error));
+        }
+    }
+
+    if (error != ARCONTROLLER_OK)
+    {
+        // the command at i - 1 is not subscribed
+        DISPATCH_Unsubscribe(deviceController, commandKeys, i - 1, callback, customData);
+    }
+
+    return error;
+}
+
+void DISPATCH_Unsubscribe (ARCONTROLLER_Device_t *deviceController, const eARCONTROLLER_DICTIONARY_KEY *commandKeys, int commandCount, ARCONTROLLER_DICTIONARY_CALLBACK_t callback, void *customData)
+{
+    int i = 0;
+
+    if ((deviceController == NULL) || (commandKeys == NULL))
+    {
+        return;
+    }
+
+    for (i = 0; i < commandCount; i++)
+    {
+        DISPATCH_SetFeatureCallback(deviceController, commandKeys[i], callback, customData, 0);
+    }
+}
+
+const DISPATCH_Arg_t *DISPATCH_GetArg (const DISPATCH_Event_t *event, const char *argKey)
+{
+    int i = 0;
+
+    if ((event == NULL) || (argKey == NULL))
+    {
+        return NULL;
+    }
+
+    for (i = 0; i < event->argCount; i++)
+    {
+        if ((event->args[i].argument == argKey) || (strcmp(event->args[i].argument, argKey) == 0))
+        {
+            return &(event->args[i]);
+        }
+    }
+
+    return NULL;
+}
+
+void DISPATCH_GetMetrics (DISPATCH_Metrics_t *metrics)
+{
+    if (metrics == NULL)
+    {
+        return;
+    }
+
+    if (eventQueue != NULL)
+    {
+        ARSAL_Mutex_Lock(&queueMutex);
+        *metrics = dispatchMetrics;
+        metrics->depth = eventQueueCount;
+        ARSAL_Mutex_Unlock(&queueMutex);
+    }
+    else
+    {
+        *metrics = dispatchMetrics;
+        metrics->processed = __atomic_load_n(&(dispatchMetrics.processed), __ATOMIC_RELAXED);
+    }
+}
+
+/*****************************************
+ *
+ *             private implementation:
+ *
+ ****************************************/
+
+static void DISPATCH_BuildEvent (DISPATCH_Event_t *event, eARCONTROLLER_DICTIONARY_KEY commandKey, int isList, ARCONTROLLER_DICTIONARY_ELEMENT_t *element)
+{
+    ARCONTROLLER_DICTIONARY_ARG_t *arg = NULL;
+    ARCONTROLLER_DICTIONARY_ARG_t *argTmp = NULL;
+    DISPATCH_Arg_t *dst = NULL;
+
+    event->commandKey = commandKey;
+    event->isList = isList;
+    event->argCount = 0;
+
+    HASH_ITER(hh, element->arguments, arg, argTmp)
+    {
+        if (event->argCount >= DISPATCH_MAX_ARGS)
+        {
+            ARSAL_PRINT(ARSAL_PRINT_WARNING, TAG, "Too many arguments for command %d", commandKey);
+            break;
+        }
+
+        dst = &(event->args[event->argCount]);
+        dst->argument = arg->argument;
+        dst->valueType = arg->valueType;
+        dst->value = arg->value;
+
+        if (arg->valueType == ARCONTROLLER_DICTIONARY_VALUE_TYPE_STRING)
+        {
+            // the string belongs to the dictionary, keep a copy
+            dst->string[0] = '\0';
+            if (arg->value.String != NULL)
+            {
+                strncpy(dst->string, arg->value.String, DISPATCH_STRING_LENGTH - 1);
+                dst->string[DISPATCH_STRING_LENGTH - 1] = '\0';
+            }
+            dst->value.String = dst->string;
+        }
+
+        event->argCount++;
+    }
+}
+
+static void DISPATCH_CopyEvent (DISPATCH_Event_t *dst, const DISPATCH_Event_t *src)
+{
+    int i = 0;
+
+    dst->commandKey = src->commandKey;
+    dst->isList = src->isList;
+    dst->argCount = src->argCount;
+
+    for (i = 0; i < src->argCount; i++)
+    {
+        dst->args[i] = src->args[i];
+        if (src->args[i].valueType == ARCONTROLLER_DICTIONARY_VALUE_TYPE_STRING)
+        {
+            dst->args[i].value.String = dst->args[i].string;
+        }
+    }
+}
+
+static void DISPATCH_Enqueue (const DISPATCH_Event_t *event)
+{
+    int slot = DISPATCH_NO_SLOT;
+
+    ARSAL_Mutex_Lock(&queueMutex);
+
+    if (!event->isList)
+    {
+        slot = pendingSlot[event->commandKey];
+    }
+
+    if (slot != DISPATCH_NO_SLOT)
+    {
+        // the queued event is superseded, update it in place
+        DISPATCH_CopyEvent(&(eventQueue[slot]), event);
+        dispatchMetrics.coalesced++;
+    }
+    else if (eventQueueCount >= eventQueueSize)
+    {
+        dispatchMetrics.dropped++;
+    }
+    else
+    {
+        slot = (eventQueueHead + eventQueueCount) % eventQueueSize;
+        DISPATCH_CopyEvent(&(eventQueue[slot]), event);
+        eventQueueCount++;
+        dispatchMetrics.pushed++;
+
+        if (!event->isList)
+        {
+            pendingSlot[event->commandKey] = slot;
+        }
+
+        if ((uint32_t)eventQueueCount > dispatchMetrics.maxDepth)
+        {
+            dispatchMetrics.maxDepth = eventQueueCount;
+        }
+
+        ARSAL_Cond_Signal(&queueCond);
+    }
+
+    ARSAL_Mutex_Unlock(&queueMutex);
+}
+
+static void *DISPATCH_WorkerRun (void *data)
+{
+    DISPATCH_Event_t event;
+
+    ARSAL_Mutex_Lock(&queueMutex);
+
+    while (1)
+    {
+        while ((eventQueueRun) && (eventQueueCount == 0))
+        {
+            ARSAL_Cond_Wait(&queueCond, &queueMutex);
+        }
+
+        if (eventQueueCount == 0)
+        {
+            // stopped and nothing left to process
+            break;
+        }
+
+        DISPATCH_CopyEvent(&event, &(eventQueue[eventQueueHead]));
+        if ((!event.isList) && (pendingSlot[event.commandKey] == eventQueueHead))
+        {
+            pendingSlot[event.commandKey] = DISPATCH_NO_SLOT;
+        }
+        eventQueueHead = (eventQueueHead + 1) % eventQueueSize;
+        eventQueueCount--;
+
+        ARSAL_Mutex_Unlock(&queueMutex);
+
+        dispatchCallback(&event, dispatchCustomData);
+
+        ARSAL_Mutex_Lock(&queueMutex);
+        dispatchMetrics.processed++;
+    }
+
+    ARSAL_Mutex_Unlock(&queueMutex);
+
+    return NULL;
+}
+
+static eARCONTROLLER_ERROR DISPATCH_SetFeatureCallback (ARCONTROLLER_Device_t *deviceController, eARCONTROLLER_DICTIONARY_KEY commandKey, ARCONTROLLER_DICTIONARY_CALLBACK_t callback, void *customData, int add)
+{
+    switch (ARCONTROLLER_DICTIONARY_Key_GetFeatureFromCommandKey(commandKey))
+    {
+    case ARCONTROLLER_DICTIONARY_KEY_GENERIC:
+        return (add) ? ARCONTROLLER_FEATURE_Generic_AddCallback(deviceController->generic, commandKey, callback, customData)
+                     : ARCONTROLLER_FEATURE_Generic_RemoveCallback(deviceController->generic, commandKey, callback, customData);
+
+    case ARCONTROLLER_DICTIONARY_KEY_ARDRONE3:
+        return (add) ? ARCONTROLLER_FEATURE_ARDrone3_AddCallback(deviceController->aRDrone3, commandKey, callback, customData)
+                     : ARCONTROLLER_FEATURE_ARDrone3_RemoveCallback(deviceController->aRDrone3, commandKey, callback, customData);
+
+    case ARCONTROLLER_DICTIONARY_KEY_JUMPINGSUMO:
+        return (add) ? ARCONTROLLER_FEATURE_JumpingSumo_AddCallback(deviceController->jumpingSumo, commandKey, callback, customData)
+                     : ARCONTROLLER_FEATURE_JumpingSumo_RemoveCallback(deviceController->jumpingSumo, commandKey, callback, customData);
+
+    case ARCONTROLLER_DICTIONARY_KEY_MINIDRONE:
+        return (add) ? ARCONTROLLER_FEATURE_MiniDrone_AddCallback(deviceController->miniDrone, commandKey, callback, customData)
+                     : ARCONTROLLER_FEATURE_MiniDrone_RemoveCallback(deviceController->miniDrone, commandKey, callback, customData);
+
+    case ARCONTROLLER_DICTIONARY_KEY_SKYCONTROLLER:
+        return (add) ? ARCONTROLLER_FEATURE_SkyController_AddCallback(deviceController->skyController, commandKey, callback, customData)
+                     : ARCONTROLLER_FEATURE_SkyController_RemoveCallback(deviceController->skyController, commandKey, callback, customData);
+
+    case ARCONTROLLER_DICTIONARY_KEY_UNKNOWN_FEATURE_1:
+        return (add) ? ARCONTROLLER_FEATURE_UnknownFeature1_AddCallback(deviceController->unknown_feature_1, commandKey, callback, customData)
+                     : ARCONTROLLER_FEATURE_UnknownFeature1_RemoveCallback(deviceController->unknown_feature_1, commandKey, callback, customData);
+
+    case ARCONTROLLER_DICTIONARY_KEY_COMMON:
+        return (add) ? ARCONTROLLER_FEATURE_Common_AddCallback(deviceController->common, commandKey, callback, customData)
+                     : ARCONTROLLER_FEATURE_Common_RemoveCallback(deviceController->common, commandKey, callback, customData);
+
+    case ARCONTROLLER_DICTIONARY_KEY_COMMONDEBUG:
+        return (add) ? ARCONTROLLER_FEATURE_CommonDebug_AddCallback(deviceController->commonDebug, commandKey, callback, customData)
+                     : ARCONTROLLER_FEATURE_CommonDebug_RemoveCallback(deviceController->commonDebug, commandKey, callback, customData);
+
+    case ARCONTROLLER_DICTIONARY_KEY_PRO:
+        return (add) ? ARCONTROLLER_FEATURE_Pro_AddCallback(deviceController->pro, commandKey, callback, customData)
+                     : ARCONTROLLER_FEATURE_Pro_RemoveCallback(deviceController->pro, commandKey, callback, customData);
+
+    case ARCONTROLLER_DICTIONARY_KEY_WIFI:
+        return (add) ? ARCONTROLLER_FEATURE_Wifi_AddCallback(deviceController->wifi, commandKey, callback, customData)
+                     : ARCONTROLLER_FEATURE_Wifi_RemoveCallback(deviceController->wifi, commandKey, callback, customData);
+
+    default:
+        return ARCONTROLLER_ERROR_BAD_PARAMETER;
+    }
+}
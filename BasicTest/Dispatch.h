@@ -0,0 +1,133 @@
+/**
+ * @file Dispatch.h
+ * @brief Dispatch of the commands received from the drone, inline or on a pool of worker threads
+ * @date 19/10/2026
+ */
+
+#ifndef _DISPATCH_H_
+#define _DISPATCH_H_
+
+#include <stdint.h>
+
+#include <libARController/ARController.h>
+
+#define DISPATCH_MAX_ARGS 8 /**< Maximum number of arguments copied for a command */
+#define DISPATCH_STRING_LENGTH 128 /**< Maximum length of a string argument, longer strings are truncated */
+
+/**
+ * @brief Dispatch mode
+ */
+typedef enum
+{
+    DISPATCH_MODE_INLINE = 0, /**< The callback is called by the thread receiving the command */
+    DISPATCH_MODE_ASYNC, /**< The command is queued and the callback is called by a worker thread */
+
+    DISPATCH_MODE_MAX,
+} eDISPATCH_MODE;
+
+/**
+ * @brief Copy of an argument of a command
+ */
+typedef struct
+{
+    const char *argument; /**< Key of the argument, one of the ARCONTROLLER_DICTIONARY_KEY_* strings */
+    eARCONTROLLER_DICTIONARY_VALUE_TYPE valueType;
+    ARCONTROLLER_DICTIONARY_VALUE_t value; /**< for a string value, value.String points to string */
+    char string[DISPATCH_STRING_LENGTH];
+} DISPATCH_Arg_t;
+
+/**
+ * @brief Copy of a command received ; a list command is dispatched as one event per element
+ */
+typedef struct
+{
+    eARCONTROLLER_DICTIONARY_KEY commandKey;
+    int isList; /**< '1' if the event is an element of a list command ; list events are never coalesced */
+    int argCount;
+    DISPATCH_Arg_t args[DISPATCH_MAX_ARGS];
+} DISPATCH_Event_t;
+
+/**
+ * @brief Counters of the dispatch queue
+ */
+typedef struct
+{
+    uint32_t depth; /**< Number of events currently queued */
+    uint32_t maxDepth; /**< Highest number of events queued at the same time */
+    uint32_t pushed; /**< Number of events queued */
+    uint32_t coalesced; /**< Number of events which replaced a queued event of the same command */
+    uint32_t dropped; /**< Number of events dropped because the queue was full */
+    uint32_t processed; /**< Number of events given to the callback */
+} DISPATCH_Metrics_t;
+
+/**
+ * @brief Callback called for each event dispatched
+ * @param[in] event The event ; only valid during the call
+ * @param[in] customData Data given to DISPATCH_Init()
+ */
+typedef void (*DISPATCH_Callback_t) (const DISPATCH_Event_t *event, void *customData);
+
+/**
+ * @brief Initialize the dispatcher
+ * @post DISPATCH_Destroy() must be called
+ * @param[in] mode Dispatch mode
+ * @param[in] workerCount Number of worker threads, ignored in DISPATCH_MODE_INLINE
+ * @param[in] queueSize Maximum number of events queued, ignored in DISPATCH_MODE_INLINE
+ * @param[in] callback Callback called for each event
+ * @param[in] customData Data given to the callback
+ * @return 0 if no error occurred
+ */
+int DISPATCH_Init (eDISPATCH_MODE mode, int workerCount, int queueSize, DISPATCH_Callback_t callback, void *customData);
+
+/**
+ * @brief Stop the workers once the queued events are processed and free the queue
+ */
+void DISPATCH_Destroy (void);
+
+/**
+ * @brief Dispatch a command received from the drone
+ * @note Called from the command received callback ; never blocks on the workers.
+ * A queued event of the same non-list command is replaced by the new one, and when the queue is full the new event is dropped.
+ * @param[in] commandKey Key of the command received
+ * @param[in] elementDictionary Element dictionary given to the callback
+ */
+void DISPATCH_Push (eARCONTROLLER_DICTIONARY_KEY commandKey, ARCONTROLLER_DICTIONARY_ELEMENT_t *elementDictionary);
+
+/**
+ * @brief Subscribe a callback to a set of commands
+ * @note Unlike ARCONTROLLER_Device_AddCommandReceivedCallback(), the callback is registered on the feature of each command,
+ * so the commands out of the set are never given to the callback nor copied in the dispatch queue.
+ * @param deviceController The device controller
+ * @param[in] commandKeys Keys of the commands of interest
+ * @param[in] commandCount Number of keys
+ * @param[in] callback Callback called when one of the commands is received
+ * @param[in] customData Data given to the callback
+ * @return executing error ; on error, the commands already subscribed are unsubscribed
+ */
+eARCONTROLLER_ERROR DISPATCH_Subscribe (ARCONTROLLER_Device_t *deviceController, const eARCONTROLLER_DICTIONARY_KEY *commandKeys, int commandCount, ARCONTROLLER_DICTIONARY_CALLBACK_t callback, void *customData);
+
+/**
+ * @brief Unsubscribe a callback from a set of commands
+ * @param deviceController The device controller
+ * @param[in] commandKeys Keys given to DISPATCH_Subscribe()
+ * @param[in] commandCount Number of keys
+ * @param[in] callback Callback given to DISPATCH_Subscribe()
+ * @param[in] customData Data given to DISPATCH_Subscribe()
+ */
+void DISPATCH_Unsubscribe (ARCONTROLLER_Device_t *deviceController, const eARCONTROLLER_DICTIONARY_KEY *commandKeys, int commandCount, ARCONTROLLER_DICTIONARY_CALLBACK_t callback, void *customData);
+
+/**
+ * @brief Find an argument in an event
+ * @param[in] event The event
+ * @param[in] argKey Key of the argument
+ * @return the argument or NULL if not found
+ */
+const DISPATCH_Arg_t *DISPATCH_GetArg (const DISPATCH_Event_t *event, const char *argKey);
+
+/**
+ * @brief Get the counters of the dispatch queue
+ * @param[out] metrics The counters
+ */
+void DISPATCH_GetMetrics (DISPATCH_Metrics_t *metrics);
+
+#endif /* _DISPATCH_H_ */
@@ -0,0 +1,378 @@
+/**
+ * @file FrameMeta.c
+ * @brief This file contains sources about the per-frame metadata extraction
+ * @date 19/10/2026
+ *
+ * Called by the video sink writer thread with the frames it has taken from its queue, so the stream thread never parses.
+ * The frames the sink drops before writing them only get a row with their index and reception time.
+ * The frames from the device controller carry no auTimestamp: the rows are stamped with the reception time.
+ */
+
+/*****************************************
+ *
+ *             include file :
+ *
+ *****************************************/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <libARSAL/ARSAL.h>
+#include <libARStream2/arstream2_h264_parser.h>
+#include <libARStream2/arstream2_h264_sei.h>
+
+#include "FrameMeta.h"
+
+/*****************************************
+ *
+ *             define :
+ *
+ *****************************************/
+#define TAG "FrameMeta"
+
+#define FRAMEMETA_NALU_TYPE_SLICE 1
+#define FRAMEMETA_NALU_TYPE_SLICE_IDR 5
+#define FRAMEMETA_NALU_TYPE_SEI 6
+
+#define FRAMEMETA_NO_FRAME UINT32_MAX // frame index of the rows not filled yet
+
+/*****************************************
+ *
+ *             private header:
+ *
+ ****************************************/
+
+static int FRAMEMETA_ExtractSei (const uint8_t *data, uint32_t size, ARSTREAM2_H264Sei_ParrotStreamingV1_t *streaming, uint16_t *sliceMbCount);
+static int FRAMEMETA_NaluType (const uint8_t *data, uint32_t size, uint32_t startCode);
+static void FRAMEMETA_CopyRow (FRAMEMETA_Table_t *dst, uint32_t dstRow, const FRAMEMETA_Table_t *src, uint32_t srcRow);
+
+/*****************************************
+ *
+ *             implementation :
+ *
+ *****************************************/
+
+static int metaInitialized = 0;
+static ARSAL_Mutex_t metaMutex;
+static ARSTREAM2_H264Parser_Handle parser = NULL;
+static FRAMEMETA_Table_t *history = NULL; // ring of rows, row of frame i is i % capacity
+static uint32_t nextFrame = 0; // after the highest frame index received ; the rows before it may still be waiting for their frame
+
+int FRAMEMETA_Init (uint32_t historySize)
+{
+    ARSTREAM2_H264Parser_Config_t config;
+    eARSTREAM2_ERROR error = ARSTREAM2_OK;
+
+    if ((historySize == 0) || (metaInitialized))
+    {
+        return -1;
+    }
+
+    memset(&config, 0, sizeof(config));
+    config.extractUserDataSei = 1;
+    config.printLogs = 0;
+
+    error = ARSTREAM2_H264Parser_Init(&parser, &config);
+    if (error != ARSTREAM2_OK)
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, TAG, "Parser init failed: %d", error);
+        return -1;
+    }
+
+    history = FRAMEMETA_TableNew(historySize);
+    if (history == NULL)
+    {
+        ARSTREAM2_H264Parser_Free(parser);
+        parser = NULL;
+        return -1;
+    }
+
+    memset(history->frameIndex, 0xFF, historySize * sizeof(uint32_t));
+    nextFrame = 0;
+    ARSAL_Mutex_Init(&metaMutex);
+    metaInitialized = 1;
+
+    return 0;
+}
+
+void FRAMEMETA_Destroy (void)
+{
+    if (!metaInitialized)
+    {
+        return;
+    }
+
+    metaInitialized = 0;
+    ARSAL_Mutex_Destroy(&metaMutex);
+    FRAMEMETA_TableDelete(&history);
+    ARSTREAM2_H264Parser_Free(parser);
+    parser = NULL;
+}
+
+void FRAMEMETA_ProcessFrame (uint32_t frameIndex, const uint8_t *data, uint32_t size, int isIFrame, const struct timespec *receivedTime, void *customData)
+{
+    ARSTREAM2_H264Sei_ParrotStreamingV1_t streaming;
+    uint16_t sliceMbCount[FRAMEMETA_MAX_SLICE_COUNT];
+    int hasSei = 0;
+    uint32_t row = 0;
+
+    if ((!metaInitialized) || (receivedTime == NULL))
+    {
+        return;
+    }
+
+    // parsed out of the lock: the readers only wait for the row copy
+    memset(&streaming, 0, sizeof(streaming));
+    if (data != NULL)
+    {
+        hasSei = FRAMEMETA_ExtractSei(data, size, &streaming, sliceMbCount);
+    }
+
+    ARSAL_Mutex_Lock(&metaMutex);
+
+    if (frameIndex + history->capacity < nextFrame)
+    {
+        // older than the rows kept
+        ARSAL_Mutex_Unlock(&metaMutex);
+        return;
+    }
+
+    row = frameIndex % history->capacity;
+    history->frameIndex[row] = frameIndex;
+    history->timestampUs[row] = (uint64_t)receivedTime->tv_sec * 1000000 + receivedTime->tv_nsec / 1000;
+    history->isIFrame[row] = (isIFrame != 0);
+    history->isParsed[row] = (data != NULL);
+    history->hasStreamingSei[row] = hasSei;
+    history->indexInGop[row] = hasSei ? streaming.indexInGop : 0;
+    history->sliceCount[row] = hasSei ? streaming.sliceCount : 0;
+    memset(&(history->sliceMbCount[row * FRAMEMETA_MAX_SLICE_COUNT]), 0, FRAMEMETA_MAX_SLICE_COUNT * sizeof(uint16_t));
+    if (hasSei)
+    {
+        memcpy(&(history->sliceMbCount[row * FRAMEMETA_MAX_SLICE_COUNT]), sliceMbCount, streaming.sliceCount * sizeof(uint16_t));
+    }
+
+    if (frameIndex >= nextFrame)
+    {
+        nextFrame = frameIndex + 1;
+    }
+    history->count = (nextFrame < history->capacity) ? nextFrame : history->capacity;
+
+    ARSAL_Mutex_Unlock(&metaMutex);
+}
+
+FRAMEMETA_Table_t *FRAMEMETA_TableNew (uint32_t capacity)
+{
+    FRAMEMETA_Table_t *table = NULL;
+
+    if (capacity == 0)
+    {
+        return NULL;
+    }
+
+    table = calloc(1, sizeof(FRAMEMETA_Table_t));
+    if (table == NULL)
+    {
+        return NULL;
+    }
+
+    table->capacity = capacity;
+    table->frameIndex = calloc(capacity, sizeof(uint32_t));
+    table->timestampUs = calloc(capacity, sizeof(uint64_t));
+    table->isIFrame = calloc(capacity, sizeof(uint8_t));
+    table->isParsed = calloc(capacity, sizeof(uint8_t));
+    table->hasStreamingSei = calloc(capacity, sizeof(uint8_t));
+    table->indexInGop = calloc(capacity, sizeof(uint8_t));
+    table->sliceCount = calloc(capacity, sizeof(uint8_t));
+    table->sliceMbCount = calloc((size_t)capacity * FRAMEMETA_MAX_SLICE_COUNT, sizeof(uint16_t));
+
+    if ((table->frameIndex == NULL) || (table->timestampUs == NULL) || (table->isIFrame == NULL) || (table->isParsed == NULL) ||
+        (table->hasStreamingSei == NULL) ||
+        (table->indexInGop == NULL) || (table->sliceCount == NULL) || (table->sliceMbCount == NULL))
+    {
+        FRAMEMETA_TableDelete(&table);
+    }
+
+    return table;
+}
+
+void FRAMEMETA_TableDelete (FRAMEMETA_Table_t **table)
+{
+    if ((table == NULL) || (*table == NULL))
+    {
+        return;
+    }
+
+    free((*table)->frameIndex);
+    free((*table)->timestampUs);
+    free((*table)->isIFrame);
+    free((*table)->isParsed);
+    free((*table)->hasStreamingSei);
+    free((*table)->indexInGop);
+    free((*table)->sliceCount);
+    free((*table)->sliceMbCount);
+    free(*table);
+    *table = NULL;
+}
+
+uint32_t FRAMEMETA_CopyRows (uint32_t firstFrame, FRAMEMETA_Table_t *table)
+{
+    uint32_t oldestFrame = 0;
+    uint32_t frame = 0;
+
+    if ((!metaInitialized) || (table == NULL))
+    {
+        return firstFrame;
+    }
+
+    ARSAL_Mutex_Lock(&metaMutex);
+
+    oldestFrame = nextFrame - history->count;
+    frame = (firstFrame < oldestFrame) ? oldestFrame : firstFrame;
+
+    for (table->count = 0; (table->count < table->capacity) && (frame < nextFrame); table->count++, frame++)
+    {
+        if (history->frameIndex[frame % history->capacity] != frame)
+        {
+            // still queued in the video sink
+            break;
+        }
+        FRAMEMETA_CopyRow(table, table->count, history, frame % history->capacity);
+    }
+
+    ARSAL_Mutex_Unlock(&metaMutex);
+
+    return frame;
+}
+
+uint32_t FRAMEMETA_WriteCsv (FILE *out)
+{
+    FRAMEMETA_Table_t *table = NULL;
+    uint32_t rows = 0;
+    uint32_t row = 0;
+    uint32_t slice = 0;
+
+    if ((!metaInitialized) || (out == NULL))
+    {
+        return 0;
+    }
+
+    table = FRAMEMETA_TableNew(history->capacity);
+    if (table == NULL)
+    {
+        return 0;
+    }
+
+    FRAMEMETA_CopyRows(0, table);
+
+    fprintf(out, "frameIndex,timestampUs,isIFrame,isParsed,hasStreamingSei,indexInGop,sliceCount,sliceMbCount\n");
+    for (row = 0; row < table->count; row++)
+    {
+        fprintf(out, "%u,%llu,%u,%u,%u,%u,%u,", table->frameIndex[row], (unsigned long long)table->timestampUs[row], table->isIFrame[row],
+                table->isParsed[row], table->hasStreamingSei[row], table->indexInGop[row], table->sliceCount[row]);
+        for (slice = 0; slice < table->sliceCount[row]; slice++)
+        {
+            fprintf(out, "%s%u", (slice > 0) ? " " : "", table->sliceMbCount[row * FRAMEMETA_MAX_SLICE_COUNT + slice]);
+        }
+        fprintf(out, "\n");
+        rows++;
+    }
+
+    FRAMEMETA_TableDelete(&table);
+
+    return rows;
+}
+
+/*****************************************
+ *
+ *             private implementation:
+ *
+ ****************************************/
+
+// parse the NAL units up to the first slice ; 1 if a "Parrot Streaming" v1 user data SEI has been found.
+// The parser scans a NAL unit up to the next start code: the type of each NAL unit is read first, so the slices are never scanned.
+static int FRAMEMETA_ExtractSei (const uint8_t *data, uint32_t size, ARSTREAM2_H264Sei_ParrotStreamingV1_t *streaming, uint16_t *sliceMbCount)
+{
+    eARSTREAM2_ERROR error = ARSTREAM2_OK;
+    unsigned int naluStart = 0;
+    unsigned int nextStartCode = 0;
+    unsigned int offset = 0;
+    unsigned int seiSize = 0;
+    void *sei = NULL;
+    int naluType = 0;
+    int seiCount = 0;
+    int i = 0;
+
+    while (offset < size)
+    {
+        // the SEI comes before the slices
+        naluType = FRAMEMETA_NaluType(data, size, offset);
+        if ((naluType < 0) || (naluType == FRAMEMETA_NALU_TYPE_SLICE) || (naluType == FRAMEMETA_NALU_TYPE_SLICE_IDR))
+        {
+            break;
+        }
+
+        nextStartCode = 0;
+        error = ARSTREAM2_H264Parser_ReadNextNalu_buffer(parser, (void *)(data + offset), size - offset, &naluStart, &nextStartCode);
+        if (error != ARSTREAM2_OK)
+        {
+            break;
+        }
+
+        if (naluType == FRAMEMETA_NALU_TYPE_SEI)
+        {
+            if (ARSTREAM2_H264Parser_ParseNalu(parser, NULL) == ARSTREAM2_OK)
+            {
+                seiCount = ARSTREAM2_H264Parser_GetUserDataSeiCount(parser);
+                for (i = 0; i < seiCount; i++)
+                {
+                    if ((ARSTREAM2_H264Parser_GetUserDataSei(parser, i, &sei, &seiSize) == ARSTREAM2_OK) &&
+                        (ARSTREAM2_H264Sei_IsUserDataParrotStreamingV1(sei, seiSize) == 1) &&
+                        (ARSTREAM2_H264Sei_DeserializeUserDataParrotStreamingV1(sei, seiSize, streaming, sliceMbCount) == ARSTREAM2_OK))
+                    {
+                        return 1;
+                    }
+                }
+            }
+        }
+
+        if (nextStartCode <= naluStart)
+        {
+            // last NAL unit of the frame
+            break;
+        }
+        offset += nextStartCode;
+    }
+
+    return 0;
+}
+
+// type of the NAL unit whose start code is at startCode ; -1 if there is none
+static int FRAMEMETA_NaluType (const uint8_t *data, uint32_t size, uint32_t startCode)
+{
+    uint32_t i = startCode;
+
+    while ((i < size) && (data[i] == 0))
+    {
+        i++;
+    }
+
+    if ((i - startCode < 2) || (i + 1 >= size) || (data[i] != 1))
+    {
+        return -1;
+    }
+
+    return data[i + 1] & 0x1F;
+}
+
+static void FRAMEMETA_CopyRow (FRAMEMETA_Table_t *dst, uint32_t dstRow, const FRAMEMETA_Table_t *src, uint32_t srcRow)
+{
+    dst->frameIndex[dstRow] = src->frameIndex[srcRow];
+    dst->timestampUs[dstRow] = src->timestampUs[srcRow];
+    dst->isIFrame[dstRow] = src->isIFrame[srcRow];
+    dst->isParsed[dstRow] = src->isParsed[srcRow];
+    dst->hasStreamingSei[dstRow] = src->hasStreamingSei[srcRow];
+    dst->indexInGop[dstRow] = src->indexInGop[srcRow];
+    dst->sliceCount[dstRow] = src->sliceCount[srcRow];
+    memcpy(&(dst->sliceMbCount[dstRow * FRAMEMETA_MAX_SLICE_COUNT]), &(src->sliceMbCount[srcRow * FRAMEMETA_MAX_SLICE_COUNT]),
+           FRAMEMETA_MAX_SLICE_COUNT * sizeof(uint16_t));
+}
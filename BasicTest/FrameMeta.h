@@ -0,0 +1,94 @@
+/**
+ * @file FrameMeta.h
+ * @brief Per-frame metadata of the video stream, from the "Parrot Streaming" v1 user data SEI, kept in a columnar table
+ * @date 19/10/2026
+ */
+
+#ifndef _FRAMEMETA_H_
+#define _FRAMEMETA_H_
+
+#include <stdio.h>
+#include <stdint.h>
+#include <time.h>
+
+#include <libARStream2/arstream2_h264_sei.h>
+
+#define FRAMEMETA_MAX_SLICE_COUNT ARSTREAM2_H264_SEI_PARROT_STREAMING_MAX_SLICE_COUNT /**< Maximum number of slices of a frame */
+
+/**
+ * @brief Columns of metadata, one row per frame
+ * @note sliceMbCount holds FRAMEMETA_MAX_SLICE_COUNT values per row, of which sliceCount are valid
+ */
+typedef struct
+{
+    uint32_t capacity; /**< Number of rows the columns can hold */
+    uint32_t count; /**< Number of rows filled */
+    uint32_t *frameIndex; /**< Index of the frame in the stream, given by the video sink */
+    uint64_t *timestampUs; /**< CLOCK_MONOTONIC reception time of the frame in microseconds */
+    uint8_t *isIFrame;
+    uint8_t *isParsed; /**< '0' for the frames dropped by the video sink before being written: only their time is known */
+    uint8_t *hasStreamingSei; /**< '1' if the frame carries a "Parrot Streaming" v1 user data SEI ; the next columns are 0 otherwise */
+    uint8_t *indexInGop;
+    uint8_t *sliceCount;
+    uint16_t *sliceMbCount;
+} FRAMEMETA_Table_t;
+
+/**
+ * @brief Initialize the metadata extractor
+ * @post FRAMEMETA_Destroy() must be called
+ * @param[in] historySize Number of frames kept ; the oldest rows are overwritten
+ * @return 0 if no error occurred
+ */
+int FRAMEMETA_Init (uint32_t historySize);
+
+/**
+ * @brief Destroy the metadata extractor
+ */
+void FRAMEMETA_Destroy (void);
+
+/**
+ * @brief Extract the metadata of a frame and store it in the row of frameIndex
+ * @note Has the signature of VIDEOSINK_FrameCallback_t ; only the NAL units before the first slice are scanned
+ * @param[in] frameIndex Index of the frame in the stream ; the frames may come out of order
+ * @param[in] data Access unit, with start codes ; NULL for a frame dropped before being written, which is only recorded
+ * @param[in] size Size of the access unit
+ * @param[in] isIFrame '1' if the frame is an I-frame
+ * @param[in] receivedTime Reception time of the frame
+ * @param[in] customData Unused
+ */
+void FRAMEMETA_ProcessFrame (uint32_t frameIndex, const uint8_t *data, uint32_t size, int isIFrame, const struct timespec *receivedTime, void *customData);
+
+/**
+ * @brief Allocate a table to copy rows to
+ * @warning This function allocate memory
+ * @post FRAMEMETA_TableDelete() must be called
+ * @param[in] capacity Number of rows
+ * @return the table or NULL on error
+ */
+FRAMEMETA_Table_t *FRAMEMETA_TableNew (uint32_t capacity);
+
+/**
+ * @brief Free a table
+ * @warning This function free memory
+ * @param table Address of the table
+ */
+void FRAMEMETA_TableDelete (FRAMEMETA_Table_t **table);
+
+/**
+ * @brief Copy the rows of the frames from firstFrame
+ * @note If firstFrame has already been overwritten, the copy starts at the oldest frame kept ;
+ * the copy stops before the first frame still queued in the video sink
+ * @param[in] firstFrame Index of the first frame wanted
+ * @param[out] table Table filled with up to table->capacity rows
+ * @return the index of the frame after the last row copied, to give as firstFrame of the next call
+ */
+uint32_t FRAMEMETA_CopyRows (uint32_t firstFrame, FRAMEMETA_Table_t *table);
+
+/**
+ * @brief Write the rows kept as CSV, one line per frame
+ * @param out Output stream
+ * @return the number of rows written
+ */
+uint32_t FRAMEMETA_WriteCsv (FILE *out);
+
+#endif /* _FRAMEMETA_H_ */
@@ -0,0 +1,837 @@
+/**
+ * @file Mission.c
+ * @brief This file contains sources about the mission runtime
+ * @date 19/10/2026
+ *
+ * The runner thread gives up to MISSION_LOOKAHEAD moves to the move engine, so the next move is sent as soon as
+ * the moveByEnd of the current one is received, without a round trip through the runner. Take off, landing and
+ * wait steps are barriers: they start once all the previous moves are ended.
+ */
+
+/*****************************************
+ *
+ *             include file :
+ *
+ *****************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <math.h>
+#include <time.h>
+
+#include <libARSAL/ARSAL.h>
+#include <libARController/ARController.h>
+// the mavlink headers take the address of packed members
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Waddress-of-packed-member"
+#include <libARMavlink/ARMAVLINK_FileParser.h>
+#include <libARMavlink/ARMAVLINK_ListUtils.h>
+#pragma GCC diagnostic pop
+
+#include "Mission.h"
+#include "MoveEngine.h"
+#include "State.h"
+
+/*****************************************
+ *
+ *             define :
+ *
+ *****************************************/
+#define TAG "Mission"
+
+#define MISSION_LINE_LENGTH 256
+#define MISSION_POLL_MS 20
+
+#define DEG_TO_RAD(angle) ((float)(angle) * M_PI / 180.0)
+
+/*****************************************
+ *
+ *             private header:
+ *
+ ****************************************/
+
+/**
+ * @brief Data given to the move engine with each move
+ */
+typedef struct
+{
+    MISSION_t *mission;
+    int index;
+} MISSION_MoveContext_t;
+
+struct MISSION_t
+{
+    MISSION_Step_t *steps;
+    MISSION_StepStats_t *stats;
+    MISSION_MoveContext_t *contexts;
+    int stepCount;
+    int stepCapacity;
+
+    ARCONTROLLER_Device_t *deviceController;
+    ARSAL_Thread_t thread;
+    ARSAL_Mutex_t mutex;
+    ARSAL_Cond_t cond;
+    struct timespec startTime;
+    int started;
+    volatile sig_atomic_t stopRequested; /**< also set from a signal handler, the waits poll it */
+    int failed;
+    int inFlight; /**< Number of moves given to the move engine and not yet ended */
+};
+
+static void *MISSION_Run (void *data);
+static int MISSION_RunMove (MISSION_t *mission, int index);
+static int MISSION_RunFlyingStateStep (MISSION_t *mission, int index);
+static int MISSION_RunWait (MISSION_t *mission, int index);
+static int MISSION_WaitInFlight (MISSION_t *mission, int maxInFlight, int abortable);
+static int MISSION_IsFlyingStateReached (eMISSION_STEP_TYPE type);
+static void MISSION_MoveEnded (const MOVEENGINE_Move_t *move, const MOVEENGINE_Result_t *result, void *customData);
+static int32_t MISSION_Now (MISSION_t *mission);
+static int MISSION_ParseLine (MISSION_t *mission, char *line, int lineNumber);
+static const char *MISSION_StepTypeToString (eMISSION_STEP_TYPE type);
+
+/*****************************************
+ *
+ *             implementation :
+ *
+ *****************************************/
+
+MISSION_t *MISSION_New (void)
+{
+    MISSION_t *mission = calloc(1, sizeof(MISSION_t));
+
+    if (mission != NULL)
+    {
+        ARSAL_Mutex_Init(&(mission->mutex));
+        ARSAL_Cond_Init(&(mission->cond));
+    }
+
+    return mission;
+}
+
+void MISSION_Delete (MISSION_t **mission)
+{
+    if ((mission == NULL) || (*mission == NULL))
+    {
+        return;
+    }
+
+    if ((*mission)->started)
+    {
+        MISSION_Stop(*mission);
+        MISSION_Wait(*mission);
+    }
+
+    ARSAL_Cond_Destroy(&((*mission)->cond));
+    ARSAL_Mutex_Destroy(&((*mission)->mutex));
+
+    free((*mission)->steps);
+    free((*mission)->stats);
+    free((*mission)->contexts);
+    free(*mission);
+    *mission = NULL;
+}
+
+int MISSION_AddStep (MISSION_t *mission, const MISSION_Step_t *step)
+{
+    MISSION_Step_t *steps = NULL;
+    int capacity = 0;
+
+    if ((mission == NULL) || (step == NULL) || (mission->started) || (step->type >= MISSION_STEP_TYPE_MAX))
+    {
+        return -1;
+    }
+
+    if (mission->stepCount >= mission->stepCapacity)
+    {
+        capacity = (mission->stepCapacity == 0) ? 16 : mission->stepCapacity * 2;
+        steps = realloc(mission->steps, capacity * sizeof(MISSION_Step_t));
+        if (steps == NULL)
+        {
+            return -1;
+        }
+        mission->steps = steps;
+        mission->stepCapacity = capacity;
+    }
+
+    mission->steps[mission->stepCount++] = *step;
+
+    return 0;
+}
+
+int MISSION_LoadFile (MISSION_t *mission, const char *filePath)
+{
+    FILE *file = NULL;
+    char line[MISSION_LINE_LENGTH];
+    int lineNumber = 0;
+    int ret = 0;
+
+    if ((mission == NULL) || (filePath == NULL))
+    {
+        return -1;
+    }
+
+    file = fopen(filePath, "r");
+    if (file == NULL)
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, TAG, "Unable to open %s.", filePath);
+        return -1;
+    }
+
+    while ((ret == 0) && (fgets(line, sizeof(line), file) != NULL))
+    {
+        lineNumber++;
+        ret = MISSION_ParseLine(mission, line, lineNumber);
+    }
+
+    fclose(file);
+
+    return ret;
+}
+
+int MISSION_LoadMavlink (MISSION_t *mission, const char *filePath)
+{
+    ARMAVLINK_FileParser_t *fileParser = NULL;
+    mission_item_list_t *missionItemList = NULL;
+    mavlink_mission_item_t *item = NULL;
+    eARMAVLINK_ERROR error = ARMAVLINK_OK;
+    MISSION_Step_t step;
+    int itemCount = 0;
+    int ret = 0;
+    int i = 0;
+
+    if ((mission == NULL) || (filePath == NULL))
+    {
+        return -1;
+    }
+
+    fileParser = ARMAVLINK_FileParser_New(&error);
+    if (error == ARMAVLINK_OK)
+    {
+        missionItemList = ARMAVLINK_ListUtils_MissionItemListNew();
+        if (missionItemList == NULL)
+        {
+            error = ARMAVLINK_ERROR_ALLOC;
+        }
+    }
+
+    if (error == ARMAVLINK_OK)
+    {
+        error = ARMAVLINK_FileParser_Parse(fileParser, filePath, missionItemList);
+    }
+
+    if (error != ARMAVLINK_OK)
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, TAG, "Unable to parse %s: %s", filePath, ARMAVLINK_Error_ToString(error));
+        ret = -1;
+    }
+    else
+    {
+        itemCount = ARMAVLINK_ListUtils_MissionItemListGetSize(missionItemList);
+    }
+
+    for (i = 0; (ret == 0) && (i < itemCount); i++)
+    {
+        item = ARMAVLINK_ListUtils_MissionItemListGet(missionItemList, i);
+        memset(&step, 0, sizeof(step));
+
+        switch (item->command)
+        {
+        case MAV_CMD_NAV_TAKEOFF:
+            step.type = MISSION_STEP_TYPE_TAKEOFF;
+            break;
+
+        case MAV_CMD_NAV_LAND:
+            step.type = MISSION_STEP_TYPE_LAND;
+            break;
+
+        case MAV_CMD_CONDITION_DELAY:
+            if ((item->param1 < 0) || (item->param1 > MISSION_WAIT_MAX_MS / 1000))
+            {
+                ARSAL_PRINT(ARSAL_PRINT_ERROR, TAG, "Item %d: delay %f s is out of range.", item->seq, item->param1);
+                ret = -1;
+                break;
+            }
+            step.type = MISSION_STEP_TYPE_WAIT;
+            step.waitMs = (int)(item->param1 * 1000);
+            break;
+
+        case MAV_CMD_NAV_WAYPOINT:
+            // the drone only knows relative moves in its own frame: the NED offsets would need its heading at the start of each move
+            if (item->frame != MAV_FRAME_BODY_OFFSET_NED)
+            {
+                ARSAL_PRINT(ARSAL_PRINT_ERROR, TAG, "Item %d: waypoint frame %d is not MAV_FRAME_BODY_OFFSET_NED.", item->seq, item->frame);
+                ret = -1;
+                break;
+            }
+            step.type = MISSION_STEP_TYPE_MOVE;
+            step.dX = item->x;
+            step.dY = item->y;
+            step.dZ = item->z;
+            step.dPsi = DEG_TO_RAD(item->param4);
+            break;
+
+        default:
+            ARSAL_PRINT(ARSAL_PRINT_ERROR, TAG, "Item %d: command %d is not supported.", item->seq, item->command);
+            ret = -1;
+            break;
+        }
+
+        if (ret == 0)
+        {
+            ret = MISSION_AddStep(mission, &step);
+        }
+    }
+
+    ARMAVLINK_ListUtils_MissionItemListDelete(&missionItemList);
+    ARMAVLINK_FileParser_Delete(&fileParser);
+
+    return ret;
+}
+
+int MISSION_Start (MISSION_t *mission, ARCONTROLLER_Device_t *deviceController)
+{
+    int i = 0;
+
+    if ((mission == NULL) || (deviceController == NULL) || (mission->started))
+    {
+        return -1;
+    }
+
+    // the stats of the previous run are replaced
+    free(mission->stats);
+    free(mission->contexts);
+    mission->stats = calloc(mission->stepCount + 1, sizeof(MISSION_StepStats_t));
+    mission->contexts = calloc(mission->stepCount + 1, sizeof(MISSION_MoveContext_t));
+    if ((mission->stats == NULL) || (mission->contexts == NULL))
+    {
+        free(mission->stats);
+        free(mission->contexts);
+        mission->stats = NULL;
+        mission->contexts = NULL;
+        return -1;
+    }
+
+    for (i = 0; i < mission->stepCount; i++)
+    {
+        mission->stats[i].submitMs = -1;
+        mission->stats[i].startMs = -1;
+        mission->stats[i].endMs = -1;
+        mission->contexts[i].mission = mission;
+        mission->contexts[i].index = i;
+    }
+
+    mission->deviceController = deviceController;
+    mission->stopRequested = 0;
+    mission->failed = 0;
+    mission->inFlight = 0;
+    clock_gettime(CLOCK_MONOTONIC, &(mission->startTime));
+
+    if (ARSAL_Thread_Create(&(mission->thread), MISSION_Run, mission) != 0)
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, TAG, "Creation of mission thread failed.");
+        return -1;
+    }
+
+    mission->started = 1;
+
+    return 0;
+}
+
+void MISSION_Stop (MISSION_t *mission)
+{
+    if (mission == NULL)
+    {
+        return;
+    }
+
+    ARSAL_Mutex_Lock(&(mission->mutex));
+    mission->stopRequested = 1;
+    ARSAL_Cond_Broadcast(&(mission->cond));
+    ARSAL_Mutex_Unlock(&(mission->mutex));
+}
+
+void MISSION_StopFromSignal (MISSION_t *mission)
+{
+    if (mission != NULL)
+    {
+        mission->stopRequested = 1;
+    }
+}
+
+int MISSION_Wait (MISSION_t *mission)
+{
+    int ret = 0;
+    int i = 0;
+
+    if ((mission == NULL) || (!mission->started))
+    {
+        return -1;
+    }
+
+    ARSAL_Thread_Join(mission->thread, NULL);
+    ARSAL_Thread_Destroy(&(mission->thread));
+    mission->started = 0;
+
+    for (i = 0; i < mission->stepCount; i++)
+    {
+        if (!mission->stats[i].done)
+        {
+            ret = -1;
+        }
+    }
+
+    return ret;
+}
+
+int MISSION_GetStepCount (MISSION_t *mission)
+{
+    return (mission != NULL) ? mission->stepCount : 0;
+}
+
+int MISSION_GetStepStats (MISSION_t *mission, int index, MISSION_StepStats_t *stats)
+{
+    if ((mission == NULL) || (mission->stats == NULL) || (stats == NULL) || (index < 0) || (index >= mission->stepCount))
+    {
+        return -1;
+    }
+
+    ARSAL_Mutex_Lock(&(mission->mutex));
+    *stats = mission->stats[index];
+    ARSAL_Mutex_Unlock(&(mission->mutex));
+
+    return 0;
+}
+
+void MISSION_PrintReport (MISSION_t *mission, FILE *out)
+{
+    MISSION_StepStats_t stats;
+    int32_t previousEndMs = 0;
+    int32_t missionEndMs = 0;
+    int32_t totalGapMs = 0;
+    int32_t gapMs = 0;
+    int doneCount = 0;
+    int i = 0;
+
+    if ((mission == NULL) || (out == NULL))
+    {
+        return;
+    }
+
+    fprintf(out, "step  type     submit    start      end  duration   gap  result\n");
+
+    for (i = 0; i < mission->stepCount; i++)
+    {
+        if (MISSION_GetStepStats(mission, i, &stats) != 0)
+        {
+            break;
+        }
+
+        if (stats.submitMs < 0)
+        {
+            fprintf(out, "%4d  %-7s  not run\n", i, MISSION_StepTypeToString(mission->steps[i].type));
+            continue;
+        }
+
+        gapMs = ((stats.startMs >= 0) && (i > 0)) ? stats.startMs - previousEndMs : 0;
+        totalGapMs += gapMs;
+
+        fprintf(out, "%4d  %-7s  %6d  %7d  %7d  %8d  %4d  %s (%d)\n", i, MISSION_StepTypeToString(mission->steps[i].type),
+                stats.submitMs, stats.startMs, stats.endMs,
+                ((stats.startMs >= 0) && (stats.endMs >= 0)) ? stats.endMs - stats.startMs : -1,
+                gapMs, stats.done ? "ok" : "failed", stats.error);
+
+        if (stats.done)
+        {
+            doneCount++;
+        }
+        if (stats.endMs >= 0)
+        {
+            previousEndMs = stats.endMs;
+            // a move dropped by a stop ends before the move in flight
+            missionEndMs = (stats.endMs > missionEndMs) ? stats.endMs : missionEndMs;
+        }
+    }
+
+    fprintf(out, "%d/%d steps done in %d ms, %d ms between steps\n", doneCount, mission->stepCount, missionEndMs, totalGapMs);
+}
+
+/*****************************************
+ *
+ *             private implementation:
+ *
+ ****************************************/
+
+static void *MISSION_Run (void *data)
+{
+    MISSION_t *mission = (MISSION_t *)data;
+    int ret = 0;
+    int i = 0;
+
+    for (i = 0; (ret == 0) && (i < mission->stepCount); i++)
+    {
+        switch (mission->steps[i].type)
+        {
+        case MISSION_STEP_TYPE_MOVE:
+            ret = MISSION_RunMove(mission, i);
+            break;
+
+        case MISSION_STEP_TYPE_TAKEOFF:
+        case MISSION_STEP_TYPE_LAND:
+            ret = MISSION_RunFlyingStateStep(mission, i);
+            break;
+
+        case MISSION_STEP_TYPE_WAIT:
+            ret = MISSION_RunWait(mission, i);
+            break;
+
+        default:
+            ret = -1;
+            break;
+        }
+    }
+
+    if (ret != 0)
+    {
+        // a step failed or the mission is stopped: the moves not yet sent must not be flown, nor the current one continued
+        ARSAL_PRINT(ARSAL_PRINT_WARNING, TAG, "Mission aborted at step %d, landing.", i - 1);
+        MOVEENGINE_Abort();
+        if (mission->deviceController->aRDrone3->sendPilotingLanding(mission->deviceController->aRDrone3) != ARCONTROLLER_OK)
+        {
+            ARSAL_PRINT(ARSAL_PRINT_ERROR, TAG, "Landing failed.");
+        }
+    }
+
+    // the moves ended by MOVEENGINE_Abort() are already reported
+    MISSION_WaitInFlight(mission, 0, 0);
+
+    return NULL;
+}
+
+static int MISSION_RunMove (MISSION_t *mission, int index)
+{
+    MISSION_Step_t *step = &(mission->steps[index]);
+
+    // keep the move engine fed, but not with the whole mission: a stop only has a few moves to drop
+    if (MISSION_WaitInFlight(mission, MISSION_LOOKAHEAD - 1, 1) != 0)
+    {
+        return -1;
+    }
+
+    ARSAL_Mutex_Lock(&(mission->mutex));
+    mission->inFlight++;
+    mission->stats[index].submitMs = MISSION_Now(mission);
+    ARSAL_Mutex_Unlock(&(mission->mutex));
+
+    // the callback can be called before the return if the move cannot be sent
+    if (MOVEENGINE_QueueMoveWithCallback(step->dX, step->dY, step->dZ, step->dPsi, MISSION_MoveEnded, &(mission->contexts[index]), NULL) != 0)
+    {
+        ARSAL_Mutex_Lock(&(mission->mutex));
+        mission->inFlight--;
+        mission->stats[index].error = -1;
+        mission->failed = 1;
+        ARSAL_Mutex_Unlock(&(mission->mutex));
+        return -1;
+    }
+
+    return 0;
+}
+
+static int MISSION_RunFlyingStateStep (MISSION_t *mission, int index)
+{
+    eMISSION_STEP_TYPE type = mission->steps[index].type;
+    eARCONTROLLER_ERROR error = ARCONTROLLER_OK;
+    int32_t startMs = 0;
+    int reached = 0;
+
+    if (MISSION_WaitInFlight(mission, 0, 1) != 0)
+    {
+        return -1;
+    }
+
+    ARSAL_Mutex_Lock(&(mission->mutex));
+    mission->stats[index].submitMs = MISSION_Now(mission);
+    mission->stats[index].startMs = mission->stats[index].submitMs;
+    startMs = mission->stats[index].startMs;
+    ARSAL_Mutex_Unlock(&(mission->mutex));
+
+    if (type == MISSION_STEP_TYPE_TAKEOFF)
+    {
+        error = mission->deviceController->aRDrone3->sendPilotingTakeOff(mission->deviceController->aRDrone3);
+    }
+    else
+    {
+        error = mission->deviceController->aRDrone3->sendPilotingLanding(mission->deviceController->aRDrone3);
+    }
+
+    if (error != ARCONTROLLER_OK)
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, TAG, "Step %d: %s failed: %s", index, MISSION_StepTypeToString(type), ARCONTROLLER_Error_ToString(error));
+    }
+
+    ARSAL_Mutex_Lock(&(mission->mutex));
+
+    while ((error == ARCONTROLLER_OK) && (!mission->stopRequested) && (!reached))
+    {
+        reached = MISSION_IsFlyingStateReached(type);
+        if (!reached)
+        {
+            if (MISSION_Now(mission) - startMs > MISSION_STEP_TIMEOUT_MS)
+            {
+                ARSAL_PRINT(ARSAL_PRINT_ERROR, TAG, "Step %d: %s timed out.", index, MISSION_StepTypeToString(type));
+                break;
+            }
+            ARSAL_Cond_Timedwait(&(mission->cond), &(mission->mutex), MISSION_POLL_MS);
+        }
+    }
+
+    mission->stats[index].endMs = MISSION_Now(mission);
+    mission->stats[index].done = reached;
+    mission->stats[index].error = reached ? 0 : -1;
+
+    ARSAL_Mutex_Unlock(&(mission->mutex));
+
+    return reached ? 0 : -1;
+}
+
+static int MISSION_RunWait (MISSION_t *mission, int index)
+{
+    int32_t startMs = 0;
+    int32_t elapsedMs = 0;
+    int ret = 0;
+
+    if (MISSION_WaitInFlight(mission, 0, 1) != 0)
+    {
+        return -1;
+    }
+
+    ARSAL_Mutex_Lock(&(mission->mutex));
+
+    startMs = MISSION_Now(mission);
+    mission->stats[index].submitMs = startMs;
+    mission->stats[index].startMs = startMs;
+
+    while ((!mission->stopRequested) && ((elapsedMs = MISSION_Now(mission) - startMs) < mission->steps[index].waitMs))
+    {
+        // polled: MISSION_StopFromSignal() does not signal the condition
+        ARSAL_Cond_Timedwait(&(mission->cond), &(mission->mutex),
+                             (mission->steps[index].waitMs - elapsedMs < MISSION_POLL_MS) ? mission->steps[index].waitMs - elapsedMs : MISSION_POLL_MS);
+    }
+
+    ret = mission->stopRequested ? -1 : 0;
+    mission->stats[index].endMs = MISSION_Now(mission);
+    mission->stats[index].done = (ret == 0);
+    mission->stats[index].error = ret;
+
+    ARSAL_Mutex_Unlock(&(mission->mutex));
+
+    return ret;
+}
+
+// wait until at most maxInFlight moves are in flight ; -1 if the mission is stopped, failed or timed out
+// when abortable, returns as soon as the mission is stopped or failed, so the queued moves can be dropped
+static int MISSION_WaitInFlight (MISSION_t *mission, int maxInFlight, int abortable)
+{
+    int32_t startMs = 0;
+    int ret = 0;
+
+    ARSAL_Mutex_Lock(&(mission->mutex));
+
+    startMs = MISSION_Now(mission);
+
+    while (mission->inFlight > maxInFlight)
+    {
+        if ((abortable) && ((mission->stopRequested) || (mission->failed)))
+        {
+            break;
+        }
+        if (MISSION_Now(mission) - startMs > MISSION_STEP_TIMEOUT_MS)
+        {
+            ARSAL_PRINT(ARSAL_PRINT_ERROR, TAG, "%d moves still in flight after %d ms.", mission->inFlight, MISSION_STEP_TIMEOUT_MS);
+            ret = -1;
+            break;
+        }
+        ARSAL_Cond_Timedwait(&(mission->cond), &(mission->mutex), MISSION_POLL_MS);
+    }
+
+    if ((mission->stopRequested) || (mission->failed))
+    {
+        ret = -1;
+    }
+
+    ARSAL_Mutex_Unlock(&(mission->mutex));
+
+    return ret;
+}
+
+static int MISSION_IsFlyingStateReached (eMISSION_STEP_TYPE type)
+{
+    STATE_Snapshot_t snapshot;
+
+    STATE_GetSnapshot(&snapshot);
+
+    if (!snapshot.flyingState.valid)
+    {
+        return 0;
+    }
+
+    if (type == MISSION_STEP_TYPE_TAKEOFF)
+    {
+        return ((snapshot.flyingState.state == ARCOMMANDS_ARDRONE3_PILOTINGSTATE_FLYINGSTATECHANGED_STATE_HOVERING) ||
+                (snapshot.flyingState.state == ARCOMMANDS_ARDRONE3_PILOTINGSTATE_FLYINGSTATECHANGED_STATE_FLYING));
+    }
+
+    return (snapshot.flyingState.state == ARCOMMANDS_ARDRONE3_PILOTINGSTATE_FLYINGSTATECHANGED_STATE_LANDED);
+}
+
+// called by the move engine, from the thread receiving the commands or from the runner
+static void MISSION_MoveEnded (const MOVEENGINE_Move_t *move, const MOVEENGINE_Result_t *result, void *customData)
+{
+    MISSION_MoveContext_t *context = (MISSION_MoveContext_t *)customData;
+    MISSION_t *mission = context->mission;
+    MISSION_StepStats_t *stats = &(mission->stats[context->index]);
+
+    ARSAL_Mutex_Lock(&(mission->mutex));
+
+    stats->endMs = MISSION_Now(mission);
+    if ((result->flightMs > 0) || (result->error == ARCOMMANDS_ARDRONE3_PILOTINGEVENT_MOVEBYEND_ERROR_OK))
+    {
+        stats->startMs = stats->endMs - result->flightMs;
+    }
+    stats->error = result->error;
+    stats->done = (result->error == ARCOMMANDS_ARDRONE3_PILOTINGEVENT_MOVEBYEND_ERROR_OK);
+
+    if (!stats->done)
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, TAG, "Step %d: move %u failed: error %d", context->index, move->id, result->error);
+        mission->failed = 1;
+    }
+
+    mission->inFlight--;
+    ARSAL_Cond_Broadcast(&(mission->cond));
+
+    ARSAL_Mutex_Unlock(&(mission->mutex));
+}
+
+static int32_t MISSION_Now (MISSION_t *mission)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return ARSAL_Time_ComputeTimespecMsTimeDiff(&(mission->startTime), &now);
+}
+
+static int MISSION_ParseLine (MISSION_t *mission, char *line, int lineNumber)
+{
+    MISSION_Step_t step;
+    char command[32];
+    char *comment = NULL;
+    float values[4] = {0, 0, 0, 0};
+    int valueCount = 0;
+    int expected = 1;
+
+    comment = strchr(line, '#');
+    if (comment != NULL)
+    {
+        *comment = '\0';
+    }
+
+    valueCount = sscanf(line, "%31s %f %f %f %f", command, &values[0], &values[1], &values[2], &values[3]) - 1;
+    if (valueCount < 0)
+    {
+        // empty line
+        return 0;
+    }
+
+    memset(&step, 0, sizeof(step));
+    step.type = MISSION_STEP_TYPE_MOVE;
+
+    if (strcmp(command, "takeoff") == 0)
+    {
+        step.type = MISSION_STEP_TYPE_TAKEOFF;
+        expected = 0;
+    }
+    else if (strcmp(command, "land") == 0)
+    {
+        step.type = MISSION_STEP_TYPE_LAND;
+        expected = 0;
+    }
+    else if (strcmp(command, "wait") == 0)
+    {
+        step.type = MISSION_STEP_TYPE_WAIT;
+        step.waitMs = (int)values[0];
+    }
+    else if (strcmp(command, "forward") == 0)
+    {
+        step.dX = values[0];
+    }
+    else if (strcmp(command, "backward") == 0)
+    {
+        step.dX = -values[0];
+    }
+    else if (strcmp(command, "right") == 0)
+    {
+        step.dY = values[0];
+    }
+    else if (strcmp(command, "left") == 0)
+    {
+        step.dY = -values[0];
+    }
+    else if (strcmp(command, "down") == 0)
+    {
+        step.dZ = values[0];
+    }
+    else if (strcmp(command, "up") == 0)
+    {
+        step.dZ = -values[0];
+    }
+    else if (strcmp(command, "turn") == 0)
+    {
+        step.dPsi = DEG_TO_RAD(values[0]);
+    }
+    else if (strcmp(command, "move") == 0)
+    {
+        step.dX = values[0];
+        step.dY = values[1];
+        step.dZ = values[2];
+        step.dPsi = DEG_TO_RAD(values[3]);
+        expected = 4;
+    }
+    else
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, TAG, "Line %d: unknown command '%s'.", lineNumber, command);
+        return -1;
+    }
+
+    if (valueCount != expected)
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, TAG, "Line %d: '%s' expects %d values.", lineNumber, command, expected);
+        return -1;
+    }
+
+    if ((step.type == MISSION_STEP_TYPE_WAIT) && ((values[0] < 0) || (values[0] > MISSION_WAIT_MAX_MS)))
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, TAG, "Line %d: '%s' expects a duration between 0 and %d ms.", lineNumber, command, MISSION_WAIT_MAX_MS);
+        return -1;
+    }
+
+    return MISSION_AddStep(mission, &step);
+}
+
+static const char *MISSION_StepTypeToString (eMISSION_STEP_TYPE type)
+{
+    switch (type)
+    {
+    case MISSION_STEP_TYPE_TAKEOFF:
+        return "takeoff";
+    case MISSION_STEP_TYPE_LAND:
+        return "land";
+    case MISSION_STEP_TYPE_MOVE:
+        return "move";
+    case MISSION_STEP_TYPE_WAIT:
+        return "wait";
+    default:
+        return "unknown";
+    }
+}
@@ -0,0 +1,158 @@
+/**
+ * @file Mission.h
+ * @brief Mission runtime: a list of steps executed by a thread, the next move being queued while the current one is executed
+ * @date 19/10/2026
+ */
+
+#ifndef _MISSION_H_
+#define _MISSION_H_
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include <libARController/ARController.h>
+
+#define MISSION_LOOKAHEAD 2 /**< Maximum number of moves given to the move engine ahead of their end */
+#define MISSION_STEP_TIMEOUT_MS 30000 /**< Maximum duration of a step before the mission is aborted */
+#define MISSION_WAIT_MAX_MS (60 * 60 * 1000) /**< Maximum duration of a wait step */
+
+/**
+ * @brief Mission, opaque
+ */
+typedef struct MISSION_t MISSION_t;
+
+/**
+ * @brief Type of a step
+ */
+typedef enum
+{
+    MISSION_STEP_TYPE_TAKEOFF = 0, /**< Take off and wait for the hovering state */
+    MISSION_STEP_TYPE_LAND, /**< Land and wait for the landed state */
+    MISSION_STEP_TYPE_MOVE, /**< Relative move, queued ahead of the previous moves */
+    MISSION_STEP_TYPE_WAIT, /**< Wait once the previous moves are ended */
+
+    MISSION_STEP_TYPE_MAX,
+} eMISSION_STEP_TYPE;
+
+/**
+ * @brief Step of a mission
+ */
+typedef struct
+{
+    eMISSION_STEP_TYPE type;
+    float dX; /**< MISSION_STEP_TYPE_MOVE: displacement along the front axis in meters */
+    float dY; /**< MISSION_STEP_TYPE_MOVE: displacement along the right axis in meters */
+    float dZ; /**< MISSION_STEP_TYPE_MOVE: displacement along the down axis in meters */
+    float dPsi; /**< MISSION_STEP_TYPE_MOVE: rotation of heading in radian */
+    int waitMs; /**< MISSION_STEP_TYPE_WAIT: time to wait in milliseconds */
+} MISSION_Step_t;
+
+/**
+ * @brief Timings of a step, in milliseconds since the start of the mission ; -1 if not reached
+ */
+typedef struct
+{
+    int32_t submitMs; /**< The step is given to the drone, or to the move engine for a move */
+    int32_t startMs; /**< The command of the step is sent to the drone */
+    int32_t endMs; /**< The step is ended */
+    int done; /**< '1' if the step is ended without error */
+    int error; /**< eARCOMMANDS_ARDRONE3_PILOTINGEVENT_MOVEBYEND_ERROR for a move, 0 or -1 otherwise */
+} MISSION_StepStats_t;
+
+/**
+ * @brief Create an empty mission
+ * @warning This function allocate memory
+ * @post MISSION_Delete() must be called
+ * @return the mission or NULL on error
+ */
+MISSION_t *MISSION_New (void);
+
+/**
+ * @brief Delete a mission ; the mission is stopped first if it is running
+ * @warning This function free memory
+ * @param mission Address of the mission
+ */
+void MISSION_Delete (MISSION_t **mission);
+
+/**
+ * @brief Add a step at the end of a mission
+ * @param mission The mission, not started
+ * @param[in] step The step
+ * @return 0 if no error occurred
+ */
+int MISSION_AddStep (MISSION_t *mission, const MISSION_Step_t *step);
+
+/**
+ * @brief Add the steps of a mission file
+ * @note One step per line: takeoff, land, forward/backward/left/right/up/down <meters>, turn <degrees>,
+ * move <dX> <dY> <dZ> <dPsi in degrees>, wait <ms> ; '#' starts a comment.
+ * @param mission The mission, not started
+ * @param[in] filePath Path of the file
+ * @return 0 if no error occurred, -1 if the file cannot be read or a line is invalid
+ */
+int MISSION_LoadFile (MISSION_t *mission, const char *filePath);
+
+/**
+ * @brief Add the steps of a mavlink mission file, parsed by ARMAVLINK_FileParser_Parse()
+ * @note Supported items: MAV_CMD_NAV_TAKEOFF, MAV_CMD_NAV_LAND, MAV_CMD_CONDITION_DELAY and MAV_CMD_NAV_WAYPOINT
+ * in MAV_FRAME_BODY_OFFSET_NED only (x, y, z in meters, param4 heading change in degrees) ; the offsets are flown in the frame of the drone.
+ * @param mission The mission, not started
+ * @param[in] filePath Path of the file
+ * @return 0 if no error occurred, -1 if the file cannot be parsed or contains an unsupported item
+ */
+int MISSION_LoadMavlink (MISSION_t *mission, const char *filePath);
+
+/**
+ * @brief Start the mission on its own thread
+ * @note The move engine must be initialized on the same device, and the state snapshot kept up to date
+ * @param mission The mission
+ * @param deviceController The device controller
+ * @return 0 if the mission is started
+ */
+int MISSION_Start (MISSION_t *mission, ARCONTROLLER_Device_t *deviceController);
+
+/**
+ * @brief Ask a running mission to stop
+ * @note Does not block ; as when a step fails, the current move is abandoned, the moves not yet sent are dropped and the drone is landed
+ * @param mission The mission
+ */
+void MISSION_Stop (MISSION_t *mission);
+
+/**
+ * @brief Same as MISSION_Stop(), from a signal handler
+ * @note Only sets a flag, polled by the mission thread every few milliseconds
+ * @param mission The mission
+ */
+void MISSION_StopFromSignal (MISSION_t *mission);
+
+/**
+ * @brief Wait for the end of a mission
+ * @param mission The mission
+ * @return 0 if all the steps are done, -1 otherwise
+ */
+int MISSION_Wait (MISSION_t *mission);
+
+/**
+ * @brief Get the number of steps of a mission
+ * @param mission The mission
+ * @return the number of steps
+ */
+int MISSION_GetStepCount (MISSION_t *mission);
+
+/**
+ * @brief Get the timings of a step
+ * @param mission The mission
+ * @param[in] index Index of the step
+ * @param[out] stats The timings
+ * @return 0 if no error occurred, -1 if index is out of range
+ */
+int MISSION_GetStepStats (MISSION_t *mission, int index, MISSION_StepStats_t *stats);
+
+/**
+ * @brief Print the timings of each step, with the gap between the end of a step and the start of the next one
+ * @param mission The mission
+ * @param out Output stream
+ */
+void MISSION_PrintReport (MISSION_t *mission, FILE *out);
+
+#endif /* _MISSION_H_ */
@@ -17,12 +17,21 @@
 #include <unistd.h>
 #include <signal.h>
 #include <errno.h>
+#include <math.h>
+#include <fcntl.h>
 
 #include <libARSAL/ARSAL.h>
 #include <libARController/ARController.h>
 #include <libARDiscovery/ARDiscovery.h>
 
 #include "Move.h"
+#include "State.h"
+#include "Dispatch.h"
+#include "MoveEngine.h"
+#include "Mission.h"
+#include "Simulator.h"
+#include "VideoSink.h"
+#include "FrameMeta.h"
 #include "ihm.h"
 
 /*****************************************
@@ -42,9 +51,27 @@
 #define FIFO_DIR_PATTERN "/tmp/arsdk_XXXXXX"
 #define FIFO_NAME "arsdk_fifo"
 
+// frames queued between the stream thread and the FIFO, about one second at 30 fps
+#define VIDEO_QUEUE_SIZE 30
+
+// metadata of the last five minutes of video, written next to the binary on exit
+#define FRAME_META_HISTORY (30 * 60 * 5)
+#define FRAME_META_CSV "frame_meta.csv"
+
+// commands are processed by one worker: the ncurses IHM must not be drawn from several threads
+#define COMMAND_DISPATCH_MODE DISPATCH_MODE_ASYNC
+#define COMMAND_WORKER_COUNT 1
+#define COMMAND_QUEUE_SIZE 64
+
 #define VMAX 3	//en m/s
 #define VTURNMAX 15 // en °/s
 
+#define DEG_TO_RAD(angle) ((float)(angle) * M_PI / 180.0)
+
+// a move taking more than MOVE_TIMEOUT_FACTOR times its expected duration is considered lost
+#define MOVE_TIMEOUT_FACTOR 2
+#define MOVE_TIMEOUT_MARGIN_MS 5000
+
 #define IHM
 /*****************************************
  *
@@ -66,14 +93,33 @@ int gIHMRun = 1;
 char gErrorStr[ERROR_STR_LENGTH];
 IHM_t *ihm = NULL;
 
-FILE *videoOut = NULL;
+int videoFd = -1;
 int frameNb = 0;
 ARSAL_Sem_t stateSem;
 pid_t child = 0;
 
+// commands given to commandReceived ; the others are not copied nor dispatched
+static const eARCONTROLLER_DICTIONARY_KEY subscribedCommands[] = {
+    ARCONTROLLER_DICTIONARY_KEY_COMMON_COMMONSTATE_BATTERYSTATECHANGED,
+    ARCONTROLLER_DICTIONARY_KEY_COMMON_COMMONSTATE_SENSORSSTATESLISTCHANGED,
+    ARCONTROLLER_DICTIONARY_KEY_ARDRONE3_PILOTINGSTATE_FLYINGSTATECHANGED,
+    ARCONTROLLER_DICTIONARY_KEY_ARDRONE3_PILOTINGSTATE_ATTITUDECHANGED,
+    ARCONTROLLER_DICTIONARY_KEY_ARDRONE3_PILOTINGSTATE_SPEEDCHANGED,
+    ARCONTROLLER_DICTIONARY_KEY_ARDRONE3_PILOTINGSTATE_ALTITUDECHANGED,
+    ARCONTROLLER_DICTIONARY_KEY_ARDRONE3_PILOTINGSTATE_POSITIONCHANGED,
+    ARCONTROLLER_DICTIONARY_KEY_ARDRONE3_GPSSETTINGSSTATE_GPSFIXSTATECHANGED,
+    ARCONTROLLER_DICTIONARY_KEY_ARDRONE3_PILOTINGEVENT_MOVEBYEND,
+};
+#define SUBSCRIBED_COMMANDS_COUNT (sizeof(subscribedCommands) / sizeof(subscribedCommands[0]))
+
+// mission running, stopped instead of the whole program on IHM exit
+static MISSION_t *mission = NULL;
+
 static void signal_handler(int signal)
 {
     gIHMRun = 0;
+    // the mission thread polls the flag and lands the drone
+    MISSION_StopFromSignal(mission);
 }
 
 ARCONTROLLER_Device_t* init(void)
@@ -121,6 +167,12 @@ ARCONTROLLER_Device_t* init(void)
 
     ARSAL_Sem_Init (&(stateSem), 0, 0);
 
+    if (STATE_Init() != 0)
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, "ERROR", "State init failed.");
+        return NULL;
+    }
+
     if (!failed)
     {
         if (DISPLAY_WITH_MPLAYER)
@@ -136,7 +188,19 @@ ARCONTROLLER_Device_t* init(void)
 
         if (DISPLAY_WITH_MPLAYER)
         {
-            videoOut = fopen(fifo_name, "w");
+            videoFd = open(fifo_name, O_WRONLY);
+            if ((videoFd < 0) || (VIDEOSINK_Init (videoFd, VIDEO_QUEUE_SIZE) != 0))
+            {
+                ARSAL_PRINT(ARSAL_PRINT_ERROR, TAG, "Creation of video sink failed.");
+            }
+            else if (FRAMEMETA_Init (FRAME_META_HISTORY) == 0)
+            {
+                VIDEOSINK_SetFrameCallback (FRAMEMETA_ProcessFrame, NULL);
+            }
+            else
+            {
+                ARSAL_PRINT(ARSAL_PRINT_ERROR, TAG, "Creation of frame metadata extractor failed.");
+            }
         }
     }
 
@@ -154,6 +218,15 @@ ARCONTROLLER_Device_t* init(void)
     }
 #endif
 
+    if (!failed)
+    {
+        if (DISPATCH_Init (COMMAND_DISPATCH_MODE, COMMAND_WORKER_COUNT, COMMAND_QUEUE_SIZE, commandProcessed, NULL) != 0)
+        {
+            ARSAL_PRINT (ARSAL_PRINT_ERROR, TAG, "Creation of command dispatcher failed.");
+            failed = 1;
+        }
+    }
+
     // create a discovery device
     if (!failed)
     {
@@ -197,6 +270,15 @@ ARCONTROLLER_Device_t* init(void)
         }
     }
 
+    if (!failed)
+    {
+        if (MOVEENGINE_Init (deviceController, moveEnded, NULL) != 0)
+        {
+            ARSAL_PRINT (ARSAL_PRINT_ERROR, TAG, "Creation of move engine failed.");
+            failed = 1;
+        }
+    }
+
     if (!failed)
     {
         ARDISCOVERY_Device_Delete (&device);
@@ -214,10 +296,10 @@ ARCONTROLLER_Device_t* init(void)
         }
     }
 
-    // add the command received callback to be informed when a command has been received from the device
+    // add the command received callback to be informed when a command of interest has been received from the device
     if (!failed)
     {
-        error = ARCONTROLLER_Device_AddCommandReceivedCallback (deviceController, commandReceived, deviceController);
+        error = DISPATCH_Subscribe (deviceController, subscribedCommands, SUBSCRIBED_COMMANDS_COUNT, commandReceived, deviceController);
 
         if (error != ARCONTROLLER_OK)
         {
@@ -279,10 +361,14 @@ ARCONTROLLER_Device_t* init(void)
         }
     }
 
-    if (!failed)
+    if (failed)
     {
-        IHM_PrintInfo(ihm, "Running ... ('q' to quit)");
+        // no mission must be flown with a half initialized controller
+        supp_ihm(deviceController);
+        return NULL;
     }
+
+    IHM_PrintInfo(ihm, "Running ... ('q' to quit)");
 	return(deviceController);
 }
 
@@ -318,10 +404,41 @@ int supp_ihm(ARCONTROLLER_Device_t *deviceController)
         ARSAL_PRINT(ARSAL_PRINT_INFO, TAG, "ARCONTROLLER_Device_Delete ...");
         ARCONTROLLER_Device_Delete (&deviceController);
 
+        // no more commands can be received, process the queued ones
+        DISPATCH_Destroy ();
+        MOVEENGINE_Destroy ();
+
+        DISPATCH_Metrics_t commandMetrics;
+
+        DISPATCH_GetMetrics (&commandMetrics);
+        ARSAL_PRINT(ARSAL_PRINT_INFO, TAG, "commands: %u queued, %u coalesced, %u dropped (queue full), %u processed ; queue depth max %u",
+                    commandMetrics.pushed, commandMetrics.coalesced, commandMetrics.dropped, commandMetrics.processed, commandMetrics.maxDepth);
+
         if (DISPLAY_WITH_MPLAYER)
         {
-            fflush (videoOut);
-            fclose (videoOut);
+            VIDEOSINK_Metrics_t videoMetrics;
+
+            VIDEOSINK_GetMetrics (&videoMetrics);
+            ARSAL_PRINT(ARSAL_PRINT_INFO, TAG, "video: %u frames written, %u dropped (queue full), %u skipped to I-frame, %u flushed, %u write errors, %u heap copies ; latency max %u ms mean %u ms",
+                        videoMetrics.written, videoMetrics.droppedFull, videoMetrics.droppedSkip, videoMetrics.flushed, videoMetrics.writeErrors, videoMetrics.heapAllocs,
+                        videoMetrics.maxLatencyMs,
+                        (videoMetrics.written > 0) ? (uint32_t)(videoMetrics.totalLatencyMs / videoMetrics.written) : 0);
+
+            VIDEOSINK_Destroy ();
+
+            FILE *metaFile = fopen (FRAME_META_CSV, "w");
+            if (metaFile != NULL)
+            {
+                ARSAL_PRINT(ARSAL_PRINT_INFO, TAG, "video: metadata of %u frames written to %s", FRAMEMETA_WriteCsv (metaFile), FRAME_META_CSV);
+                fclose (metaFile);
+            }
+            FRAMEMETA_Destroy ();
+
+            if (videoFd >= 0)
+            {
+                close (videoFd);
+                videoFd = -1;
+            }
 
             if (child > 0)
             {
@@ -331,6 +448,7 @@ int supp_ihm(ARCONTROLLER_Device_t *deviceController)
     }
 
     ARSAL_Sem_Destroy (&(stateSem));
+    STATE_Destroy ();
 
     unlink(fifo_name);
     rmdir(fifo_dir);
@@ -372,94 +490,96 @@ void stateChanged (eARCONTROLLER_DEVICE_STATE newState, eARCONTROLLER_ERROR erro
 // called when a command has been received from the drone
 void commandReceived (eARCONTROLLER_DICTIONARY_KEY commandKey, ARCONTROLLER_DICTIONARY_ELEMENT_t *elementDictionary, void *customData)
 {
-    ARCONTROLLER_Device_t *deviceController = customData;
+    // keep the typed snapshot up to date for the readers of STATE_GetSnapshot()
+    STATE_Update (commandKey, elementDictionary);
 
-    if (deviceController != NULL)
+    switch (commandKey)
     {
-        // if the command received is a battery state changed
-        if (commandKey == ARCONTROLLER_DICTIONARY_KEY_COMMON_COMMONSTATE_BATTERYSTATECHANGED)
-        {
-            ARCONTROLLER_DICTIONARY_ARG_t *arg = NULL;
-            ARCONTROLLER_DICTIONARY_ELEMENT_t *singleElement = NULL;
+    case ARCONTROLLER_DICTIONARY_KEY_ARDRONE3_PILOTINGEVENT_MOVEBYEND:
+        // the next move is sent from here, without waiting for the dispatcher
+        MOVEENGINE_OnMoveByEnd (elementDictionary);
+        break;
 
-            if (elementDictionary != NULL)
-            {
-                // get the command received in the device controller
-                HASH_FIND_STR (elementDictionary, ARCONTROLLER_DICTIONARY_SINGLE_KEY, singleElement);
-
-                if (singleElement != NULL)
-                {
-                    // get the value
-                    HASH_FIND_STR (singleElement->arguments, ARCONTROLLER_DICTIONARY_KEY_COMMON_COMMONSTATE_BATTERYSTATECHANGED_PERCENT, arg);
-
-                    if (arg != NULL)
-                    {
-                        // update UI
-                        batteryStateChanged (arg->value.U8);
-                    }
-                    else
-                    {
-                        ARSAL_PRINT(ARSAL_PRINT_ERROR, TAG, "arg is NULL");
-                    }
-                }
-                else
-                {
-                    ARSAL_PRINT(ARSAL_PRINT_ERROR, TAG, "singleElement is NULL");
-                }
-            }
-            else
-            {
-                ARSAL_PRINT(ARSAL_PRINT_ERROR, TAG, "elements is NULL");
-            }
+    case ARCONTROLLER_DICTIONARY_KEY_COMMON_COMMONSTATE_BATTERYSTATECHANGED:
+    case ARCONTROLLER_DICTIONARY_KEY_COMMON_COMMONSTATE_SENSORSSTATESLISTCHANGED:
+        // the UI is updated by commandProcessed, out of the thread receiving the commands
+        DISPATCH_Push (commandKey, elementDictionary);
+        break;
+
+    default:
+        // only needed by the snapshot: not copied into the dispatch queue
+        break;
+    }
+}
+
+// called by the dispatcher for each command received from the drone
+void commandProcessed (const DISPATCH_Event_t *event, void *customData)
+{
+    const DISPATCH_Arg_t *arg = NULL;
+
+    // if the command received is a battery state changed
+    if (event->commandKey == ARCONTROLLER_DICTIONARY_KEY_COMMON_COMMONSTATE_BATTERYSTATECHANGED)
+    {
+        // get the value
+        arg = DISPATCH_GetArg (event, ARCONTROLLER_DICTIONARY_KEY_COMMON_COMMONSTATE_BATTERYSTATECHANGED_PERCENT);
+
+        if (arg != NULL)
+        {
+            // update UI
+            batteryStateChanged (arg->value.U8);
+        }
+        else
+        {
+            ARSAL_PRINT(ARSAL_PRINT_ERROR, TAG, "arg is NULL");
         }
     }
 
-    if (commandKey == ARCONTROLLER_DICTIONARY_KEY_COMMON_COMMONSTATE_SENSORSSTATESLISTCHANGED)
+    // one event per sensor of the list
+    if (event->commandKey == ARCONTROLLER_DICTIONARY_KEY_COMMON_COMMONSTATE_SENSORSSTATESLISTCHANGED)
     {
-        ARCONTROLLER_DICTIONARY_ARG_t *arg = NULL;
+        eARCOMMANDS_COMMON_COMMONSTATE_SENSORSSTATESLISTCHANGED_SENSORNAME sensorName = ARCOMMANDS_COMMON_COMMONSTATE_SENSORSSTATESLISTCHANGED_SENSORNAME_MAX;
+        int sensorState = 0;
 
-        if (elementDictionary != NULL)
+        // get the Name
+        arg = DISPATCH_GetArg (event, ARCONTROLLER_DICTIONARY_KEY_COMMON_COMMONSTATE_SENSORSSTATESLISTCHANGED_SENSORNAME);
+        if (arg != NULL)
         {
-            ARCONTROLLER_DICTIONARY_ELEMENT_t *dictElement = NULL;
-            ARCONTROLLER_DICTIONARY_ELEMENT_t *dictTmp = NULL;
+            sensorName = arg->value.I32;
+        }
+        else
+        {
+            ARSAL_PRINT(ARSAL_PRINT_ERROR, TAG, "arg sensorName is NULL");
+        }
 
-            eARCOMMANDS_COMMON_COMMONSTATE_SENSORSSTATESLISTCHANGED_SENSORNAME sensorName = ARCOMMANDS_COMMON_COMMONSTATE_SENSORSSTATESLISTCHANGED_SENSORNAME_MAX;
-            int sensorState = 0;
+        // get the state
+        arg = DISPATCH_GetArg (event, ARCONTROLLER_DICTIONARY_KEY_COMMON_COMMONSTATE_SENSORSSTATESLISTCHANGED_SENSORSTATE);
+        if (arg != NULL)
+        {
+            sensorState = arg->value.U8;
 
-            HASH_ITER(hh, elementDictionary, dictElement, dictTmp)
-            {
-                // get the Name
-                HASH_FIND_STR (dictElement->arguments, ARCONTROLLER_DICTIONARY_KEY_COMMON_COMMONSTATE_SENSORSSTATESLISTCHANGED_SENSORNAME, arg);
-                if (arg != NULL)
-                {
-                    sensorName = arg->value.I32;
-                }
-                else
-                {
-                    ARSAL_PRINT(ARSAL_PRINT_ERROR, TAG, "arg sensorName is NULL");
-                }
-
-                // get the state
-                HASH_FIND_STR (dictElement->arguments, ARCONTROLLER_DICTIONARY_KEY_COMMON_COMMONSTATE_SENSORSSTATESLISTCHANGED_SENSORSTATE, arg);
-                if (arg != NULL)
-                {
-                    sensorState = arg->value.U8;
-
-                    ARSAL_PRINT(ARSAL_PRINT_INFO, TAG, "sensorName %d ; sensorState: %d", sensorName, sensorState);
-                }
-                else
-                {
-                    ARSAL_PRINT(ARSAL_PRINT_ERROR, TAG, "arg sensorState is NULL");
-                }
-            }
+            ARSAL_PRINT(ARSAL_PRINT_INFO, TAG, "sensorName %d ; sensorState: %d", sensorName, sensorState);
         }
         else
         {
-            ARSAL_PRINT(ARSAL_PRINT_ERROR, TAG, "elements is NULL");
+            ARSAL_PRINT(ARSAL_PRINT_ERROR, TAG, "arg sensorState is NULL");
         }
     }
 }
 
+// called by the move engine at the end of each move
+void moveEnded (const MOVEENGINE_Move_t *move, const MOVEENGINE_Result_t *result, void *customData)
+{
+    if (result->error != ARCOMMANDS_ARDRONE3_PILOTINGEVENT_MOVEBYEND_ERROR_OK)
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, TAG, "move %u failed: error %d", move->id, result->error);
+    }
+    else
+    {
+        ARSAL_PRINT(ARSAL_PRINT_INFO, TAG, "move %u done in %d ms (queued %d ms): dX %.2f dY %.2f dZ %.2f dPsi %.2f",
+                    move->id, result->flightMs, result->queuedMs, result->dX, result->dY, result->dZ, result->dPsi);
+    }
+}
+
 void batteryStateChanged (uint8_t percent)
 {
     // callback of changing of battery level
@@ -473,23 +593,22 @@ void batteryStateChanged (uint8_t percent)
 
 eARCONTROLLER_ERROR decoderConfigCallback (ARCONTROLLER_Stream_Codec_t codec, void *customData)
 {
-    if (videoOut != NULL)
+    if (videoFd >= 0)
     {
         if (codec.type == ARCONTROLLER_STREAM_CODEC_TYPE_H264)
         {
             if (DISPLAY_WITH_MPLAYER)
             {
-                fwrite(codec.parameters.h264parameters.spsBuffer, codec.parameters.h264parameters.spsSize, 1, videoOut);
-                fwrite(codec.parameters.h264parameters.ppsBuffer, codec.parameters.h264parameters.ppsSize, 1, videoOut);
-
-                fflush (videoOut);
+                // written by the video sink before the next frame
+                VIDEOSINK_SetConfig (codec.parameters.h264parameters.spsBuffer, codec.parameters.h264parameters.spsSize,
+                                     codec.parameters.h264parameters.ppsBuffer, codec.parameters.h264parameters.ppsSize);
             }
         }
 
     }
     else
     {
-        ARSAL_PRINT(ARSAL_PRINT_WARNING, TAG, "videoOut is NULL.");
+        ARSAL_PRINT(ARSAL_PRINT_WARNING, TAG, "videoFd is not open.");
     }
 
     return ARCONTROLLER_OK;
@@ -498,15 +617,14 @@ eARCONTROLLER_ERROR decoderConfigCallback (ARCONTROLLER_Stream_Codec_t codec, vo
 
 eARCONTROLLER_ERROR didReceiveFrameCallback (ARCONTROLLER_Frame_t *frame, void *customData)
 {
-    if (videoOut != NULL)
+    if (videoFd >= 0)
     {
         if (frame != NULL)
         {
             if (DISPLAY_WITH_MPLAYER)
             {
-                fwrite(frame->data, frame->used, 1, videoOut);
-
-                fflush (videoOut);
+                // copied and queued: a lagging player drops frames instead of blocking the stream thread
+                VIDEOSINK_PushFrame (frame);
             }
         }
         else
@@ -516,7 +634,7 @@ eARCONTROLLER_ERROR didReceiveFrameCallback (ARCONTROLLER_Frame_t *frame, void *
     }
     else
     {
-        ARSAL_PRINT(ARSAL_PRINT_WARNING, TAG, "videoOut is NULL.");
+        ARSAL_PRINT(ARSAL_PRINT_WARNING, TAG, "videoFd is not open.");
     }
 
     return ARCONTROLLER_OK;
@@ -549,6 +667,22 @@ void takeoff(ARCONTROLLER_Device_t* deviceController)
 	}
 }
 
+// queue a relative move and wait for its moveByEnd ; time is the expected duration of the move at half the max speed
+static void moveAndWait(float dX, float dY, float dZ, float dPsi, float time, char *errorStr)
+{
+	int timeoutMs = (int)(time * 1000 * MOVE_TIMEOUT_FACTOR) + MOVE_TIMEOUT_MARGIN_MS;
+	if(MOVEENGINE_QueueMove(dX, dY, dZ, dPsi, NULL) != 0) {
+		IHM_PrintInfo(ihm, errorStr);
+		return;
+	}
+	// the drone stops by itself at the end of the move, nothing to resend
+	if(MOVEENGINE_WaitIdle(timeoutMs) != 0) {
+		// the moveByEnd is lost: the next move must not wait for this one
+		MOVEENGINE_Abort();
+		IHM_PrintInfo(ihm, errorStr);
+	}
+}
+
 void goforward(ARCONTROLLER_Device_t* deviceController, int distance)
 {
 	if(deviceController == NULL) {
@@ -559,22 +693,7 @@ void goforward(ARCONTROLLER_Device_t* deviceController, int distance)
 		distance *= -1;
 	}
 	float time = (float) distance/(VMAX*0.5);
-	eARCONTROLLER_ERROR error = ARCONTROLLER_OK;
-	error = deviceController->aRDrone3->setPilotingPCMDPitch(deviceController->aRDrone3, 50);
-	if(error != ARCONTROLLER_OK) {
-		IHM_PrintInfo(ihm, "going forward failed");
-		return;
-	}
-        error = deviceController->aRDrone3->setPilotingPCMDFlag(deviceController->aRDrone3, 1);
-	if(error != ARCONTROLLER_OK) {
-		IHM_PrintInfo(ihm, "going forward failed");
-	}
-	sleep(time);
-	// distance traveled, now stop movement, send order until it is correctly done
-	error = !error;
-	while(error != ARCONTROLLER_OK) {
-        error = deviceController->aRDrone3->setPilotingPCMD(deviceController->aRDrone3, 0, 0, 0, 0, 0, 0);
-        }
+	moveAndWait(distance, 0, 0, 0, time, "going forward failed");
 }
 
 void gobackward(ARCONTROLLER_Device_t* deviceController, int distance)
@@ -587,22 +706,7 @@ void gobackward(ARCONTROLLER_Device_t* deviceController, int distance)
 		distance *= -1;
 	}
 	float time = (float) distance/(VMAX*0.5);
-	eARCONTROLLER_ERROR error = ARCONTROLLER_OK;
-	error = deviceController->aRDrone3->setPilotingPCMDPitch(deviceController->aRDrone3, -50);
-	if(error != ARCONTROLLER_OK) {
-		IHM_PrintInfo(ihm, "going backward failed");
-		return;
-	}
-        error = deviceController->aRDrone3->setPilotingPCMDFlag(deviceController->aRDrone3, 1);
-	if(error != ARCONTROLLER_OK) {
-		IHM_PrintInfo(ihm, "going backward failed");
-	}
-	sleep(time);
-	// distance traveled, now stop movement, send order until it is correctly done
-	error = !error;
-	while(error != ARCONTROLLER_OK) {
-        error = deviceController->aRDrone3->setPilotingPCMD(deviceController->aRDrone3, 0, 0, 0, 0, 0, 0);
-        }
+	moveAndWait(-distance, 0, 0, 0, time, "going backward failed");
 }
 
 void goup(ARCONTROLLER_Device_t* deviceController, int distance)
@@ -615,18 +719,7 @@ void goup(ARCONTROLLER_Device_t* deviceController, int distance)
 		distance *= -1;
 	}
 	float time = (float) distance/(VMAX*0.5);
-	eARCONTROLLER_ERROR error = ARCONTROLLER_OK;
-	error = deviceController->aRDrone3->setPilotingPCMDGaz(deviceController->aRDrone3, 50);
-	if(error != ARCONTROLLER_OK) {
-		IHM_PrintInfo(ihm, "going up failed");
-		return;
-	}
-	sleep(time);
-	// distance traveled, now stop movement, send order until it is correctly done
-	error = !error;
-	while(error != ARCONTROLLER_OK) {
-        error = deviceController->aRDrone3->setPilotingPCMD(deviceController->aRDrone3, 0, 0, 0, 0, 0, 0);
-        }
+	moveAndWait(0, 0, -distance, 0, time, "going up failed");
 }
 
 void godown(ARCONTROLLER_Device_t* deviceController, int distance)
@@ -639,18 +732,7 @@ void godown(ARCONTROLLER_Device_t* deviceController, int distance)
 		distance *= -1;
 	}
 	float time = (float) distance/(VMAX*0.5);
-	eARCONTROLLER_ERROR error = ARCONTROLLER_OK;
-	error = deviceController->aRDrone3->setPilotingPCMDGaz(deviceController->aRDrone3, -50);
-	if(error != ARCONTROLLER_OK) {
-		IHM_PrintInfo(ihm, "going down failed");
-		return;
-	}
-	sleep(time);
-	// distance traveled, now stop movement, send order until it is correctly done
-	error = !error;
-	while(error != ARCONTROLLER_OK) {
-        error = deviceController->aRDrone3->setPilotingPCMD(deviceController->aRDrone3, 0, 0, 0, 0, 0, 0);
-        }
+	moveAndWait(0, 0, distance, 0, time, "going down failed");
 }
 
 void goleft(ARCONTROLLER_Device_t* deviceController, int distance)
@@ -663,23 +745,7 @@ void goleft(ARCONTROLLER_Device_t* deviceController, int distance)
 		distance *= -1;
 	}
 	float time = (float) distance/(VMAX*0.5);
-	eARCONTROLLER_ERROR error = ARCONTROLLER_OK;
-	error = deviceController->aRDrone3->setPilotingPCMDRoll(deviceController->aRDrone3, -50);
-	if(error != ARCONTROLLER_OK) {
-		IHM_PrintInfo(ihm, "going left failed");
-		return;
-	}
-        error = deviceController->aRDrone3->setPilotingPCMDFlag(deviceController->aRDrone3, 1);
-	if(error != ARCONTROLLER_OK) {
-		IHM_PrintInfo(ihm, "going left failed");
-		return;
-	}
-	sleep(time);
-	// distance traveled, now stop movement, send order until it is correctly done
-	error = !error;
-	while(error != ARCONTROLLER_OK) {
-        error = deviceController->aRDrone3->setPilotingPCMD(deviceController->aRDrone3, 0, 0, 0, 0, 0, 0);
-        }
+	moveAndWait(0, -distance, 0, 0, time, "going left failed");
 }
 
 void goright(ARCONTROLLER_Device_t* deviceController, int distance)
@@ -692,23 +758,7 @@ void goright(ARCONTROLLER_Device_t* deviceController, int distance)
 		distance *= -1;
 	}
 	float time = (float) distance/(VMAX*0.5);
-	eARCONTROLLER_ERROR error = ARCONTROLLER_OK;
-	error = deviceController->aRDrone3->setPilotingPCMDRoll(deviceController->aRDrone3, 50);
-	if(error != ARCONTROLLER_OK) {
-		IHM_PrintInfo(ihm, "going right failed");
-		return;
-	}
-        error = deviceController->aRDrone3->setPilotingPCMDFlag(deviceController->aRDrone3, 1);
-	if(error != ARCONTROLLER_OK) {
-		IHM_PrintInfo(ihm, "going right failed");
-		return;
-	}
-	sleep(time);
-	// distance traveled, now stop movement, send order until it is correctly done
-	error = !error;
-	while(error != ARCONTROLLER_OK) {
-        error = deviceController->aRDrone3->setPilotingPCMD(deviceController->aRDrone3, 0, 0, 0, 0, 0, 0);
-        }
+	moveAndWait(0, distance, 0, 0, time, "going right failed");
 }
 
 void turnright(ARCONTROLLER_Device_t* deviceController, int angle)
@@ -721,18 +771,7 @@ void turnright(ARCONTROLLER_Device_t* deviceController, int angle)
 		angle *= -1;
 	}
 	float time = (float) angle/(VTURNMAX*0.5);
-	eARCONTROLLER_ERROR error = ARCONTROLLER_OK;
-	error = deviceController->aRDrone3->setPilotingPCMDYaw(deviceController->aRDrone3, 50);
-	if(error != ARCONTROLLER_OK) {
-		IHM_PrintInfo(ihm, "turning right failed");
-		return;
-	}
-	sleep(time);
-	// distance traveled, now stop movement, send order until it is correctly done
-	error = !error;
-	while(error != ARCONTROLLER_OK) {
-        error = deviceController->aRDrone3->setPilotingPCMD(deviceController->aRDrone3, 0, 0, 0, 0, 0, 0);
-        }
+	moveAndWait(0, 0, 0, DEG_TO_RAD(angle), time, "turning right failed");
 }
 
 void turnleft(ARCONTROLLER_Device_t* deviceController, int angle)
@@ -745,18 +784,7 @@ void turnleft(ARCONTROLLER_Device_t* deviceController, int angle)
 		angle *= -1;
 	}
 	float time = (float) angle/(VTURNMAX*0.5);
-	eARCONTROLLER_ERROR error = ARCONTROLLER_OK;
-	error = deviceController->aRDrone3->setPilotingPCMDYaw(deviceController->aRDrone3, -50);
-	if(error != ARCONTROLLER_OK) {
-		IHM_PrintInfo(ihm, "turning left failed");
-		return;
-	}
-	sleep(time);
-	// distance traveled, now stop movement, send order until it is correctly done
-	error = !error;
-	while(error != ARCONTROLLER_OK) {
-        error = deviceController->aRDrone3->setPilotingPCMD(deviceController->aRDrone3, 0, 0, 0, 0, 0, 0);
-        }
+	moveAndWait(0, 0, 0, -DEG_TO_RAD(angle), time, "turning left failed");
 }
 
 void emergency(ARCONTROLLER_Device_t* deviceController)
@@ -783,6 +811,13 @@ void onInputEvent (eIHM_INPUT_EVENT event, void *customData)
     IHM_PrintInfo(ihm, "IHM_INPUT_EVENT_EXIT ...");
     gIHMRun = 0;
 
+    if (mission != NULL)
+    {
+        // main() cleans up once the mission is ended
+        MISSION_Stop(mission);
+        return;
+    }
+
     if (supp_ihm(deviceController) != EXIT_SUCCESS)
     {
         printf("Error sending an event\n");
@@ -803,9 +838,96 @@ int customPrintCallback (eARSAL_PRINT_LEVEL level, const char *tag, const char *
     return 1;
 }
 
-// permet juste de passer la compilation sans soucis, pourra être utilisé pour tester les fonctions
-int main() {
-	printf("Je compile bien !\n");
-	return EXIT_SUCCESS;
+static void usage(const char *name)
+{
+	printf("Usage: %s [-n] [-m] <mission file>\n", name);
+	printf("  -n  dry run, against a simulated drone\n");
+	printf("  -m  the mission file is a mavlink mission\n");
 }
 
+// sans fichier de mission, permet juste de passer la compilation sans soucis
+int main(int argc, char *argv[]) {
+	ARCONTROLLER_Device_t *deviceController = NULL;
+	int dryRun = 0;
+	int mavlink = 0;
+	int ret = EXIT_SUCCESS;
+	int opt = 0;
+
+	while((opt = getopt(argc, argv, "nmh")) != -1) {
+		switch(opt) {
+		case 'n':
+			dryRun = 1;
+			break;
+		case 'm':
+			mavlink = 1;
+			break;
+		default:
+			usage(argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+
+	if(optind >= argc) {
+		printf("Je compile bien !\n");
+		return EXIT_SUCCESS;
+	}
+
+	mission = MISSION_New();
+	if(mission == NULL) {
+		return EXIT_FAILURE;
+	}
+	if((mavlink ? MISSION_LoadMavlink(mission, argv[optind]) : MISSION_LoadFile(mission, argv[optind])) != 0) {
+		printf("Invalid mission file %s\n", argv[optind]);
+		MISSION_Delete(&mission);
+		return EXIT_FAILURE;
+	}
+
+	if(dryRun) {
+		// init() is not called: Ctrl-C must still stop the mission
+		struct sigaction sig_action = {
+			.sa_handler = signal_handler,
+		};
+		if(sigaction(SIGINT, &sig_action, NULL) < 0) {
+			ARSAL_PRINT(ARSAL_PRINT_ERROR, "ERROR", "Unable to set SIGINT handler : %d(%s)", errno, strerror(errno));
+			MISSION_Delete(&mission);
+			return EXIT_FAILURE;
+		}
+
+		// the simulated drone gives its events to commandReceived like the device controller
+		if((STATE_Init() != 0) || (DISPATCH_Init(DISPATCH_MODE_INLINE, 0, 0, commandProcessed, NULL) != 0)) {
+			MISSION_Delete(&mission);
+			return EXIT_FAILURE;
+		}
+		deviceController = SIMULATOR_New(commandReceived, NULL);
+		if((deviceController == NULL) || (MOVEENGINE_Init(deviceController, moveEnded, NULL) != 0)) {
+			ret = EXIT_FAILURE;
+		}
+	}
+	else {
+		deviceController = init();
+		if(deviceController == NULL) {
+			ret = EXIT_FAILURE;
+		}
+	}
+
+	if(ret == EXIT_SUCCESS) {
+		if((MISSION_Start(mission, deviceController) != 0) || (MISSION_Wait(mission) != 0)) {
+			ret = EXIT_FAILURE;
+		}
+	}
+
+	if(dryRun) {
+		SIMULATOR_Delete(&deviceController);
+		DISPATCH_Destroy();
+		MOVEENGINE_Destroy();
+		STATE_Destroy();
+	}
+	else if(deviceController != NULL) {
+		supp_ihm(deviceController);
+	}
+
+	MISSION_PrintReport(mission, stdout);
+	MISSION_Delete(&mission);
+
+	return ret;
+}
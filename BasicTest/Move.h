@@ -34,12 +34,21 @@
 
 #include <ihm.h>
 
+#include "Dispatch.h"
+#include "MoveEngine.h"
+
 // called when the state of the device controller has changed
 void stateChanged (eARCONTROLLER_DEVICE_STATE newState, eARCONTROLLER_ERROR error, void *customData);
 
 // called when a command has been received from the drone
 void commandReceived (eARCONTROLLER_DICTIONARY_KEY commandKey, ARCONTROLLER_DICTIONARY_ELEMENT_t *elementDictionary, void *customData);
 
+// called by the dispatcher, out of the thread receiving the commands
+void commandProcessed (const DISPATCH_Event_t *event, void *customData);
+
+// called by the move engine at the end of each move
+void moveEnded (const MOVEENGINE_Move_t *move, const MOVEENGINE_Result_t *result, void *customData);
+
 // IHM updates from commands
 void batteryStateChanged (uint8_t percent);
 
@@ -47,7 +56,8 @@ void batteryStateChanged (uint8_t percent);
 eARCONTROLLER_ERROR didReceiveFrameCallback (ARCONTROLLER_Frame_t *frame, void *customData);
 
 eARCONTROLLER_ERROR decoderConfigCallback (ARCONTROLLER_Stream_Codec_t codec, void *customData);
-/* Movement commands */
+/* Movement commands ; each one returns at the end of the move, use MOVEENGINE_QueueMove() to chain moves without waiting.
+   The moves are sent by the move engine to the device controller given to MOVEENGINE_Init(): deviceController is only checked against NULL. */
 void takeoff (ARCONTROLLER_Device_t* deviceController);
 void land (ARCONTROLLER_Device_t* deviceController);
 void goforward(ARCONTROLLER_Device_t* deviceController, int distance);
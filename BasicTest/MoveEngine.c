@@ -0,0 +1,529 @@
+/**
+ * @file MoveEngine.c
+ * @brief This file contains sources about the non-blocking relative moves
+ * @date 19/10/2026
+ *
+ * The drone executes one moveBy at a time and reports its end with a moveByEnd event. The moves are
+ * queued here and the next one is sent from the moveByEnd event itself, so no time is lost between
+ * two moves and nothing has to sleep for an estimated flight time.
+ *
+ * Only moveByEnd drives the engine: the speed and attitude events tell nothing about which move is
+ * in progress, the readers wanting them use the state snapshot.
+ */
+
+/*****************************************
+ *
+ *             include file :
+ *
+ *****************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <libARSAL/ARSAL.h>
+#include <libARController/ARController.h>
+
+#include "MoveEngine.h"
+
+/*****************************************
+ *
+ *             define :
+ *
+ *****************************************/
+#define TAG "MoveEngine"
+
+/*****************************************
+ *
+ *             private header:
+ *
+ ****************************************/
+
+/**
+ * @brief Move queued or in progress
+ */
+typedef struct
+{
+    MOVEENGINE_Move_t move;
+    struct timespec queuedTime;
+    struct timespec startTime;
+    MOVEENGINE_MoveEndedCallback_t callback; /**< callback of this move only */
+    void *customData;
+} MOVEENGINE_Entry_t;
+
+/**
+ * @brief Move ended, to report once the lock is released
+ */
+typedef struct
+{
+    MOVEENGINE_Move_t move;
+    MOVEENGINE_Result_t result;
+    MOVEENGINE_MoveEndedCallback_t callback;
+    void *customData;
+} MOVEENGINE_Ended_t;
+
+static void MOVEENGINE_StartNext (MOVEENGINE_Ended_t *ended, int *endedCount);
+static void MOVEENGINE_Drop (int dropCurrent, MOVEENGINE_Ended_t *ended, int *endedCount);
+static void MOVEENGINE_Report (MOVEENGINE_Ended_t *ended, int endedCount);
+static int MOVEENGINE_IsIdle (void);
+
+/*****************************************
+ *
+ *             implementation :
+ *
+ *****************************************/
+
+static int engineLockCreated = 0; // the lock outlives the engine: the callers racing with MOVEENGINE_Destroy() find it valid
+static int engineInitialized = 0; // read with engineMutex locked
+static ARSAL_Mutex_t engineMutex;
+static ARSAL_Cond_t engineIdleCond;
+static ARCONTROLLER_Device_t *engineDevice = NULL;
+static MOVEENGINE_MoveEndedCallback_t engineCallback = NULL;
+static void *engineCustomData = NULL;
+
+static MOVEENGINE_Entry_t pendingMoves[MOVEENGINE_QUEUE_SIZE];
+static int pendingHead = 0;
+static int pendingCount = 0;
+static MOVEENGINE_Entry_t currentMove;
+static int currentMoveValid = 0;
+static int abandonedMove = 0; // the moveByEnd of a forgotten move is awaited before the next move is sent, see MOVEENGINE_Abort()
+static int idleWaiterCount = 0;
+static uint32_t nextMoveId = 1;
+
+int MOVEENGINE_Init (ARCONTROLLER_Device_t *deviceController, MOVEENGINE_MoveEndedCallback_t callback, void *customData)
+{
+    if ((deviceController == NULL) || (deviceController->aRDrone3 == NULL))
+    {
+        return -1;
+    }
+
+    if (!engineLockCreated)
+    {
+        if (ARSAL_Mutex_Init(&engineMutex) != 0)
+        {
+            return -1;
+        }
+        if (ARSAL_Cond_Init(&engineIdleCond) != 0)
+        {
+            ARSAL_Mutex_Destroy(&engineMutex);
+            return -1;
+        }
+        engineLockCreated = 1;
+    }
+
+    ARSAL_Mutex_Lock(&engineMutex);
+
+    if (engineInitialized)
+    {
+        ARSAL_Mutex_Unlock(&engineMutex);
+        return -1;
+    }
+
+    engineDevice = deviceController;
+    engineCallback = callback;
+    engineCustomData = customData;
+    pendingHead = 0;
+    pendingCount = 0;
+    currentMoveValid = 0;
+    abandonedMove = 0;
+    idleWaiterCount = 0;
+    engineInitialized = 1;
+
+    ARSAL_Mutex_Unlock(&engineMutex);
+
+    return 0;
+}
+
+void MOVEENGINE_Destroy (void)
+{
+    MOVEENGINE_Ended_t ended[MOVEENGINE_QUEUE_SIZE + 1];
+    int endedCount = 0;
+
+    if (!engineLockCreated)
+    {
+        return;
+    }
+
+    ARSAL_Mutex_Lock(&engineMutex);
+
+    if (!engineInitialized)
+    {
+        ARSAL_Mutex_Unlock(&engineMutex);
+        return;
+    }
+
+    engineInitialized = 0;
+    MOVEENGINE_Drop(1, ended, &endedCount);
+
+    // the waiters leave MOVEENGINE_WaitIdle() before the engine can be initialized again
+    ARSAL_Cond_Broadcast(&engineIdleCond);
+    while (idleWaiterCount > 0)
+    {
+        ARSAL_Cond_Wait(&engineIdleCond, &engineMutex);
+    }
+
+    engineDevice = NULL;
+
+    ARSAL_Mutex_Unlock(&engineMutex);
+
+    MOVEENGINE_Report(ended, endedCount);
+}
+
+int MOVEENGINE_QueueMove (float dX, float dY, float dZ, float dPsi, uint32_t *moveId)
+{
+    return MOVEENGINE_QueueMoveWithCallback(dX, dY, dZ, dPsi, NULL, NULL, moveId);
+}
+
+int MOVEENGINE_QueueMoveWithCallback (float dX, float dY, float dZ, float dPsi, MOVEENGINE_MoveEndedCallback_t callback, void *customData, uint32_t *moveId)
+{
+    MOVEENGINE_Ended_t ended[MOVEENGINE_QUEUE_SIZE];
+    MOVEENGINE_Entry_t *entry = NULL;
+    int endedCount = 0;
+
+    if (!engineLockCreated)
+    {
+        return -1;
+    }
+
+    ARSAL_Mutex_Lock(&engineMutex);
+
+    if (!engineInitialized)
+    {
+        ARSAL_Mutex_Unlock(&engineMutex);
+        return -1;
+    }
+
+    if (pendingCount >= MOVEENGINE_QUEUE_SIZE)
+    {
+        ARSAL_Mutex_Unlock(&engineMutex);
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, TAG, "Move queue is full.");
+        return -1;
+    }
+
+    entry = &(pendingMoves[(pendingHead + pendingCount) % MOVEENGINE_QUEUE_SIZE]);
+    entry->move.id = nextMoveId++;
+    entry->move.dX = dX;
+    entry->move.dY = dY;
+    entry->move.dZ = dZ;
+    entry->move.dPsi = dPsi;
+    entry->callback = callback;
+    entry->customData = customData;
+    clock_gettime(CLOCK_MONOTONIC, &(entry->queuedTime));
+    pendingCount++;
+
+    if (moveId != NULL)
+    {
+        *moveId = entry->move.id;
+    }
+
+    MOVEENGINE_StartNext(ended, &endedCount);
+
+    ARSAL_Mutex_Unlock(&engineMutex);
+
+    MOVEENGINE_Report(ended, endedCount);
+
+    return 0;
+}
+
+int MOVEENGINE_Flush (void)
+{
+    MOVEENGINE_Ended_t ended[MOVEENGINE_QUEUE_SIZE];
+    int dropped = 0;
+
+    if (!engineLockCreated)
+    {
+        return 0;
+    }
+
+    ARSAL_Mutex_Lock(&engineMutex);
+    if (engineInitialized)
+    {
+        MOVEENGINE_Drop(0, ended, &dropped);
+    }
+    ARSAL_Mutex_Unlock(&engineMutex);
+
+    MOVEENGINE_Report(ended, dropped);
+
+    return dropped;
+}
+
+int MOVEENGINE_Abort (void)
+{
+    MOVEENGINE_Ended_t ended[MOVEENGINE_QUEUE_SIZE + 1];
+    int dropped = 0;
+
+    if (!engineLockCreated)
+    {
+        return 0;
+    }
+
+    ARSAL_Mutex_Lock(&engineMutex);
+    if (engineInitialized)
+    {
+        if ((abandonedMove) && (!currentMoveValid))
+        {
+            // the moveByEnd of the forgotten move is lost too: stop waiting for it
+            abandonedMove = 0;
+        }
+        MOVEENGINE_Drop(1, ended, &dropped);
+    }
+    ARSAL_Mutex_Unlock(&engineMutex);
+
+    MOVEENGINE_Report(ended, dropped);
+
+    return dropped;
+}
+
+int MOVEENGINE_WaitIdle (int timeoutMs)
+{
+    struct timespec start;
+    struct timespec now;
+    int remainingMs = 0;
+    int ret = 0;
+
+    if (!engineLockCreated)
+    {
+        return 0;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    ARSAL_Mutex_Lock(&engineMutex);
+    idleWaiterCount++;
+
+    while ((engineInitialized) && (!MOVEENGINE_IsIdle()))
+    {
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        remainingMs = timeoutMs - ARSAL_Time_ComputeTimespecMsTimeDiff(&start, &now);
+        if (remainingMs <= 0)
+        {
+            ret = -1;
+            break;
+        }
+
+        ARSAL_Cond_Timedwait(&engineIdleCond, &engineMutex, remainingMs);
+    }
+
+    idleWaiterCount--;
+    if ((!engineInitialized) && (idleWaiterCount == 0))
+    {
+        // MOVEENGINE_Destroy() waits for the last waiter
+        ARSAL_Cond_Broadcast(&engineIdleCond);
+    }
+
+    ARSAL_Mutex_Unlock(&engineMutex);
+
+    return ret;
+}
+
+void MOVEENGINE_OnMoveByEnd (ARCONTROLLER_DICTIONARY_ELEMENT_t *elementDictionary)
+{
+    ARCONTROLLER_DICTIONARY_ELEMENT_t *singleElement = NULL;
+    ARCONTROLLER_DICTIONARY_ARG_t *arg = NULL;
+    MOVEENGINE_Ended_t ended[MOVEENGINE_QUEUE_SIZE + 1];
+    MOVEENGINE_Result_t result;
+    struct timespec now;
+    int endedCount = 0;
+
+    if ((!engineLockCreated) || (elementDictionary == NULL))
+    {
+        return;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    memset(&result, 0, sizeof(result));
+    result.error = ARCOMMANDS_ARDRONE3_PILOTINGEVENT_MOVEBYEND_ERROR_UNKNOWN;
+
+    HASH_FIND_STR (elementDictionary, ARCONTROLLER_DICTIONARY_SINGLE_KEY, singleElement);
+    if (singleElement == NULL)
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, TAG, "singleElement is NULL");
+        return;
+    }
+
+    HASH_FIND_STR (singleElement->arguments, ARCONTROLLER_DICTIONARY_KEY_ARDRONE3_PILOTINGEVENT_MOVEBYEND_DX, arg);
+    if (arg != NULL)
+    {
+        result.dX = arg->value.Float;
+    }
+    HASH_FIND_STR (singleElement->arguments, ARCONTROLLER_DICTIONARY_KEY_ARDRONE3_PILOTINGEVENT_MOVEBYEND_DY, arg);
+    if (arg != NULL)
+    {
+        result.dY = arg->value.Float;
+    }
+    HASH_FIND_STR (singleElement->arguments, ARCONTROLLER_DICTIONARY_KEY_ARDRONE3_PILOTINGEVENT_MOVEBYEND_DZ, arg);
+    if (arg != NULL)
+    {
+        result.dZ = arg->value.Float;
+    }
+    HASH_FIND_STR (singleElement->arguments, ARCONTROLLER_DICTIONARY_KEY_ARDRONE3_PILOTINGEVENT_MOVEBYEND_DPSI, arg);
+    if (arg != NULL)
+    {
+        result.dPsi = arg->value.Float;
+    }
+    HASH_FIND_STR (singleElement->arguments, ARCONTROLLER_DICTIONARY_KEY_ARDRONE3_PILOTINGEVENT_MOVEBYEND_ERROR, arg);
+    if (arg != NULL)
+    {
+        result.error = arg->value.I32;
+    }
+
+    ARSAL_Mutex_Lock(&engineMutex);
+
+    if (!engineInitialized)
+    {
+        ARSAL_Mutex_Unlock(&engineMutex);
+        return;
+    }
+
+    if (abandonedMove)
+    {
+        // no move has been sent since the forgotten one: this is its end, the pending moves can go
+        abandonedMove = 0;
+        MOVEENGINE_StartNext(ended, &endedCount);
+        ARSAL_Mutex_Unlock(&engineMutex);
+        MOVEENGINE_Report(ended, endedCount);
+        return;
+    }
+
+    if (!currentMoveValid)
+    {
+        // end of a move not sent by the engine
+        ARSAL_Mutex_Unlock(&engineMutex);
+        return;
+    }
+
+    result.queuedMs = ARSAL_Time_ComputeTimespecMsTimeDiff(&(currentMove.queuedTime), &(currentMove.startTime));
+    result.flightMs = ARSAL_Time_ComputeTimespecMsTimeDiff(&(currentMove.startTime), &now);
+    ended[0].move = currentMove.move;
+    ended[0].result = result;
+    ended[0].callback = currentMove.callback;
+    ended[0].customData = currentMove.customData;
+    endedCount = 1;
+    currentMoveValid = 0;
+
+    if (result.error != ARCOMMANDS_ARDRONE3_PILOTINGEVENT_MOVEBYEND_ERROR_OK)
+    {
+        // the next moves were planned from where this one should have ended
+        MOVEENGINE_Drop(0, ended, &endedCount);
+    }
+
+    // send the next move right away
+    MOVEENGINE_StartNext(ended, &endedCount);
+
+    ARSAL_Mutex_Unlock(&engineMutex);
+
+    MOVEENGINE_Report(ended, endedCount);
+}
+
+/*****************************************
+ *
+ *             private implementation:
+ *
+ ****************************************/
+
+// must be called with engineMutex locked ; the moves which can not be sent are added to ended
+static void MOVEENGINE_StartNext (MOVEENGINE_Ended_t *ended, int *endedCount)
+{
+    eARCONTROLLER_ERROR error = ARCONTROLLER_OK;
+    MOVEENGINE_Entry_t *entry = NULL;
+    MOVEENGINE_Ended_t *failed = NULL;
+
+    while ((!currentMoveValid) && (!abandonedMove) && (pendingCount > 0))
+    {
+        entry = &(pendingMoves[pendingHead]);
+        pendingHead = (pendingHead + 1) % MOVEENGINE_QUEUE_SIZE;
+        pendingCount--;
+
+        clock_gettime(CLOCK_MONOTONIC, &(entry->startTime));
+        error = engineDevice->aRDrone3->sendPilotingMoveBy(engineDevice->aRDrone3, entry->move.dX, entry->move.dY, entry->move.dZ, entry->move.dPsi);
+
+        if (error == ARCONTROLLER_OK)
+        {
+            currentMove = *entry;
+            currentMoveValid = 1;
+        }
+        else
+        {
+            ARSAL_PRINT(ARSAL_PRINT_ERROR, TAG, "Sending of move %u failed: %s", entry->move.id, ARCONTROLLER_Error_ToString(error));
+
+            failed = &(ended[*endedCount]);
+            memset(failed, 0, sizeof(*failed));
+            failed->move = entry->move;
+            failed->callback = entry->callback;
+            failed->customData = entry->customData;
+            failed->result.error = ARCOMMANDS_ARDRONE3_PILOTINGEVENT_MOVEBYEND_ERROR_UNKNOWN;
+            failed->result.queuedMs = ARSAL_Time_ComputeTimespecMsTimeDiff(&(entry->queuedTime), &(entry->startTime));
+            (*endedCount)++;
+        }
+    }
+
+    if (MOVEENGINE_IsIdle())
+    {
+        ARSAL_Cond_Broadcast(&engineIdleCond);
+    }
+}
+
+// must be called with engineMutex locked ; the moves dropped are added to ended with ARCOMMANDS_ARDRONE3_PILOTINGEVENT_MOVEBYEND_ERROR_INTERRUPTED
+static void MOVEENGINE_Drop (int dropCurrent, MOVEENGINE_Ended_t *ended, int *endedCount)
+{
+    MOVEENGINE_Entry_t *entry = NULL;
+    MOVEENGINE_Ended_t *dropped = NULL;
+
+    if ((dropCurrent) && (currentMoveValid))
+    {
+        dropped = &(ended[*endedCount]);
+        memset(dropped, 0, sizeof(*dropped));
+        dropped->move = currentMove.move;
+        dropped->callback = currentMove.callback;
+        dropped->customData = currentMove.customData;
+        dropped->result.error = ARCOMMANDS_ARDRONE3_PILOTINGEVENT_MOVEBYEND_ERROR_INTERRUPTED;
+        dropped->result.queuedMs = ARSAL_Time_ComputeTimespecMsTimeDiff(&(currentMove.queuedTime), &(currentMove.startTime));
+        (*endedCount)++;
+        currentMoveValid = 0;
+        abandonedMove = 1;
+    }
+
+    while (pendingCount > 0)
+    {
+        entry = &(pendingMoves[pendingHead]);
+        pendingHead = (pendingHead + 1) % MOVEENGINE_QUEUE_SIZE;
+        pendingCount--;
+
+        dropped = &(ended[*endedCount]);
+        memset(dropped, 0, sizeof(*dropped));
+        dropped->move = entry->move;
+        dropped->callback = entry->callback;
+        dropped->customData = entry->customData;
+        dropped->result.error = ARCOMMANDS_ARDRONE3_PILOTINGEVENT_MOVEBYEND_ERROR_INTERRUPTED;
+        (*endedCount)++;
+    }
+
+    if (MOVEENGINE_IsIdle())
+    {
+        ARSAL_Cond_Broadcast(&engineIdleCond);
+    }
+}
+
+static void MOVEENGINE_Report (MOVEENGINE_Ended_t *ended, int endedCount)
+{
+    int i = 0;
+
+    for (i = 0; i < endedCount; i++)
+    {
+        if (engineCallback != NULL)
+        {
+            engineCallback(&(ended[i].move), &(ended[i].result), engineCustomData);
+        }
+
+        if (ended[i].callback != NULL)
+        {
+            ended[i].callback(&(ended[i].move), &(ended[i].result), ended[i].customData);
+        }
+    }
+}
+
+// must be called with engineMutex locked
+static int MOVEENGINE_IsIdle (void)
+{
+    return ((!currentMoveValid) && (pendingCount == 0));
+}
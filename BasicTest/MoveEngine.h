@@ -0,0 +1,124 @@
+/**
+ * @file MoveEngine.h
+ * @brief Non-blocking relative moves, chained on the moveByEnd events of the drone
+ * @date 19/10/2026
+ */
+
+#ifndef _MOVEENGINE_H_
+#define _MOVEENGINE_H_
+
+#include <stdint.h>
+
+#include <libARController/ARController.h>
+
+#define MOVEENGINE_QUEUE_SIZE 32 /**< Maximum number of moves waiting to be sent */
+
+/**
+ * @brief Relative move, in the frame of the drone at the start of the move
+ */
+typedef struct
+{
+    uint32_t id; /**< Identifier given by MOVEENGINE_QueueMove() */
+    float dX; /**< Wanted displacement along the front axis in meters */
+    float dY; /**< Wanted displacement along the right axis in meters */
+    float dZ; /**< Wanted displacement along the down axis in meters */
+    float dPsi; /**< Wanted rotation of heading in radian */
+} MOVEENGINE_Move_t;
+
+/**
+ * @brief Result of a move, from the moveByEnd event
+ */
+typedef struct
+{
+    float dX; /**< Displacement done along the front axis in meters */
+    float dY; /**< Displacement done along the right axis in meters */
+    float dZ; /**< Displacement done along the down axis in meters */
+    float dPsi; /**< Rotation of heading done in radian */
+    eARCOMMANDS_ARDRONE3_PILOTINGEVENT_MOVEBYEND_ERROR error;
+    int32_t queuedMs; /**< Time between MOVEENGINE_QueueMove() and the sending of the move */
+    int32_t flightMs; /**< Time between the sending of the move and its end */
+} MOVEENGINE_Result_t;
+
+/**
+ * @brief Callback called when a move is ended
+ * @note Called by the thread receiving the commands, must not block
+ * @param[in] move The move ended
+ * @param[in] result The result of the move
+ * @param[in] customData Data given to MOVEENGINE_Init()
+ */
+typedef void (*MOVEENGINE_MoveEndedCallback_t) (const MOVEENGINE_Move_t *move, const MOVEENGINE_Result_t *result, void *customData);
+
+/**
+ * @brief Initialize the move engine
+ * @post MOVEENGINE_Destroy() must be called
+ * @param deviceController The device controller used to send the moves
+ * @param[in] callback Callback called when a move is ended ; can be NULL
+ * @param[in] customData Data given to the callback
+ * @return 0 if no error occurred
+ */
+int MOVEENGINE_Init (ARCONTROLLER_Device_t *deviceController, MOVEENGINE_MoveEndedCallback_t callback, void *customData);
+
+/**
+ * @brief Destroy the move engine
+ * @note The current move and the moves not yet sent are dropped as by MOVEENGINE_Abort() ; the callers of MOVEENGINE_WaitIdle() return before the engine is destroyed
+ */
+void MOVEENGINE_Destroy (void);
+
+/**
+ * @brief Queue a relative move
+ * @note Does not block: the move is sent at once if the drone is not moving, otherwise as soon as the moveByEnd of the previous move is received.
+ * When a move ends with an error, the moves queued after it are dropped with ARCOMMANDS_ARDRONE3_PILOTINGEVENT_MOVEBYEND_ERROR_INTERRUPTED.
+ * @param[in] dX Wanted displacement along the front axis in meters
+ * @param[in] dY Wanted displacement along the right axis in meters
+ * @param[in] dZ Wanted displacement along the down axis in meters
+ * @param[in] dPsi Wanted rotation of heading in radian
+ * @param[out] moveId Identifier of the move given to the callback ; can be NULL
+ * @return 0 if the move is queued, -1 if the queue is full or the engine is not initialized
+ */
+int MOVEENGINE_QueueMove (float dX, float dY, float dZ, float dPsi, uint32_t *moveId);
+
+/**
+ * @brief Queue a relative move with its own end callback
+ * @note Same as MOVEENGINE_QueueMove() ; callback is called after the callback given to MOVEENGINE_Init(), also when the move could not be sent
+ * @param[in] dX Wanted displacement along the front axis in meters
+ * @param[in] dY Wanted displacement along the right axis in meters
+ * @param[in] dZ Wanted displacement along the down axis in meters
+ * @param[in] dPsi Wanted rotation of heading in radian
+ * @param[in] callback Callback called at the end of this move ; can be NULL
+ * @param[in] customData Data given to the callback
+ * @param[out] moveId Identifier of the move given to the callbacks ; can be NULL
+ * @return 0 if the move is queued, -1 if the queue is full or the engine is not initialized
+ */
+int MOVEENGINE_QueueMoveWithCallback (float dX, float dY, float dZ, float dPsi, MOVEENGINE_MoveEndedCallback_t callback, void *customData, uint32_t *moveId);
+
+/**
+ * @brief Drop the moves not yet sent ; the current move continues
+ * @note The callbacks are called for each move dropped, with ARCOMMANDS_ARDRONE3_PILOTINGEVENT_MOVEBYEND_ERROR_INTERRUPTED
+ * @return the number of moves dropped
+ */
+int MOVEENGINE_Flush (void);
+
+/**
+ * @brief Drop the moves not yet sent and forget the current move, when its moveByEnd is not expected anymore
+ * @note The callbacks are called for each move dropped, with ARCOMMANDS_ARDRONE3_PILOTINGEVENT_MOVEBYEND_ERROR_INTERRUPTED.
+ * The drone may still be flying the current move: the next moves are held until its moveByEnd is received,
+ * unless MOVEENGINE_Abort() is called again before, when that moveByEnd is considered lost too.
+ * @return the number of moves dropped
+ */
+int MOVEENGINE_Abort (void);
+
+/**
+ * @brief Wait for the end of all the moves queued
+ * @param[in] timeoutMs Maximum time to wait in milliseconds
+ * @return 0 if all the moves are ended, -1 on timeout
+ */
+int MOVEENGINE_WaitIdle (int timeoutMs);
+
+/**
+ * @brief Give a moveByEnd event to the move engine
+ * @note Must be called from the command received callback, for ARCONTROLLER_DICTIONARY_KEY_ARDRONE3_PILOTINGEVENT_MOVEBYEND
+ * @param[in] elementDictionary Element dictionary given to the callback
+ */
+void MOVEENGINE_OnMoveByEnd (ARCONTROLLER_DICTIONARY_ELEMENT_t *elementDictionary);
+
+#endif /* _MOVEENGINE_H_ */
@@ -0,0 +1,431 @@
+/**
+ * @file SelfTest.c
+ * @brief Checks of the queue, move engine, video sink and mission policies, without a drone
+ * @date 19/10/2026
+ *
+ * Each module is driven through its public API: the move engine by a fake device and hand made moveByEnd
+ * events, the video sink by a pipe, the mission by the simulated Bebop. Prints one line per check and
+ * returns EXIT_FAILURE if any check failed.
+ */
+
+/*****************************************
+ *
+ *             include file :
+ *
+ *****************************************/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <signal.h>
+
+#include <libARSAL/ARSAL.h>
+#include <libARController/ARController.h>
+
+#include "State.h"
+#include "Dispatch.h"
+#include "MoveEngine.h"
+#include "Mission.h"
+#include "Simulator.h"
+#include "VideoSink.h"
+#include "FrameMeta.h"
+
+/*****************************************
+ *
+ *             define :
+ *
+ *****************************************/
+#define TAG "SelfTest"
+
+#define SELFTEST_DISPATCH_EVENTS 200
+#define SELFTEST_DISPATCH_COMMANDS 8
+#define SELFTEST_VIDEO_FRAMES 64
+#define SELFTEST_VIDEO_FRAME_SIZE 20000 /**< a few frames fill the pipe */
+#define SELFTEST_VIDEO_QUEUE_SIZE 8
+#define SELFTEST_VIDEO_I_FRAME_PERIOD 30
+#define SELFTEST_MISSION_FILE_TEMPLATE "/tmp/selftest_mission_XXXXXX"
+
+/*****************************************
+ *
+ *             private header:
+ *
+ ****************************************/
+
+static void SELFTEST_Check (int condition, const char *name);
+static void SELFTEST_Dispatch (void);
+static void SELFTEST_DispatchCallback (const DISPATCH_Event_t *event, void *customData);
+static void SELFTEST_MoveEngine (void);
+static eARCONTROLLER_ERROR SELFTEST_SendMoveBy (ARCONTROLLER_FEATURE_ARDrone3_t *feature, float dX, float dY, float dZ, float dPsi);
+static void SELFTEST_MoveEnded (const MOVEENGINE_Move_t *move, const MOVEENGINE_Result_t *result, void *customData);
+static void SELFTEST_EndMove (eARCOMMANDS_ARDRONE3_PILOTINGEVENT_MOVEBYEND_ERROR error);
+static void SELFTEST_VideoSink (void);
+static void SELFTEST_PushVideoFrames (int count, int iFramePeriod);
+static void SELFTEST_Mission (void);
+static int SELFTEST_RunMission (const char *text);
+static void SELFTEST_SimulatorCommand (eARCONTROLLER_DICTIONARY_KEY commandKey, ARCONTROLLER_DICTIONARY_ELEMENT_t *elementDictionary, void *customData);
+
+/*****************************************
+ *
+ *             implementation :
+ *
+ *****************************************/
+
+static int checkCount = 0;
+static int failureCount = 0;
+
+static int dispatchProcessed = 0;
+
+static int movesSent = 0;
+static int movesEnded = 0;
+static int movesInterrupted = 0;
+static float lastSentDX = 0;
+
+int main (int argc, char *argv[])
+{
+    // the video sink test closes the reader of the pipe
+    signal(SIGPIPE, SIG_IGN);
+
+    SELFTEST_Dispatch();
+    SELFTEST_MoveEngine();
+    SELFTEST_VideoSink();
+    SELFTEST_Mission();
+
+    printf("%d/%d checks passed\n", checkCount - failureCount, checkCount);
+
+    return (failureCount == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/*****************************************
+ *
+ *             private implementation:
+ *
+ ****************************************/
+
+static void SELFTEST_Check (int condition, const char *name)
+{
+    checkCount++;
+    if (!condition)
+    {
+        failureCount++;
+    }
+    printf("%s %s\n", condition ? "PASS" : "FAIL", name);
+}
+
+static void SELFTEST_Dispatch (void)
+{
+    ARCONTROLLER_DICTIONARY_ELEMENT_t *elementDictionary = NULL;
+    ARCONTROLLER_DICTIONARY_ELEMENT_t element;
+    ARCONTROLLER_DICTIONARY_ARG_t arg;
+    DISPATCH_Metrics_t metrics;
+    int i = 0;
+
+    memset(&element, 0, sizeof(element));
+    memset(&arg, 0, sizeof(arg));
+    element.key = ARCONTROLLER_DICTIONARY_SINGLE_KEY;
+    arg.argument = "percent";
+    arg.valueType = ARCONTROLLER_DICTIONARY_VALUE_TYPE_U8;
+    HASH_ADD_KEYPTR (hh, element.arguments, arg.argument, strlen(arg.argument), &arg);
+    HASH_ADD_KEYPTR (hh, elementDictionary, element.key, strlen(element.key), &element);
+
+    // one slow worker and a small queue: the burst is coalesced per command
+    dispatchProcessed = 0;
+    if (DISPATCH_Init(DISPATCH_MODE_ASYNC, 1, SELFTEST_DISPATCH_COMMANDS, SELFTEST_DispatchCallback, NULL) != 0)
+    {
+        SELFTEST_Check(0, "dispatch: init");
+    }
+    else
+    {
+        for (i = 0; i < SELFTEST_DISPATCH_EVENTS; i++)
+        {
+            arg.value.U8 = i % 100;
+            DISPATCH_Push((eARCONTROLLER_DICTIONARY_KEY)(i % SELFTEST_DISPATCH_COMMANDS), elementDictionary);
+        }
+        DISPATCH_GetMetrics(&metrics);
+        SELFTEST_Check(metrics.maxDepth <= SELFTEST_DISPATCH_COMMANDS, "dispatch: queue depth bounded by its size");
+        SELFTEST_Check(metrics.coalesced > 0, "dispatch: burst of the same commands coalesced");
+        SELFTEST_Check(metrics.pushed + metrics.coalesced + metrics.dropped == SELFTEST_DISPATCH_EVENTS, "dispatch: every event counted once");
+
+        // the queued events are processed before the workers stop
+        DISPATCH_Destroy();
+        DISPATCH_GetMetrics(&metrics);
+        SELFTEST_Check((metrics.processed == metrics.pushed) && (dispatchProcessed == (int)metrics.pushed), "dispatch: queued events processed on destroy");
+    }
+
+    dispatchProcessed = 0;
+    if (DISPATCH_Init(DISPATCH_MODE_INLINE, 0, 0, SELFTEST_DispatchCallback, NULL) != 0)
+    {
+        SELFTEST_Check(0, "dispatch: inline init");
+    }
+    else
+    {
+        DISPATCH_Push((eARCONTROLLER_DICTIONARY_KEY)0, elementDictionary);
+        SELFTEST_Check(dispatchProcessed == 1, "dispatch: inline event processed by the caller");
+        DISPATCH_Destroy();
+    }
+
+    HASH_CLEAR (hh, element.arguments);
+    HASH_CLEAR (hh, elementDictionary);
+}
+
+static void SELFTEST_DispatchCallback (const DISPATCH_Event_t *event, void *customData)
+{
+    usleep(1000);
+    dispatchProcessed++;
+}
+
+static void SELFTEST_MoveEngine (void)
+{
+    ARCONTROLLER_FEATURE_ARDrone3_t feature;
+    ARCONTROLLER_Device_t deviceController;
+
+    memset(&feature, 0, sizeof(feature));
+    memset(&deviceController, 0, sizeof(deviceController));
+    feature.sendPilotingMoveBy = SELFTEST_SendMoveBy;
+    deviceController.aRDrone3 = &feature;
+
+    movesSent = 0;
+    movesEnded = 0;
+    movesInterrupted = 0;
+    if (MOVEENGINE_Init(&deviceController, SELFTEST_MoveEnded, NULL) != 0)
+    {
+        SELFTEST_Check(0, "move engine: init");
+        return;
+    }
+
+    // chaining: one move in flight, the next one sent by its moveByEnd
+    MOVEENGINE_QueueMove(1, 0, 0, 0, NULL);
+    MOVEENGINE_QueueMove(2, 0, 0, 0, NULL);
+    SELFTEST_Check(movesSent == 1, "move engine: one move sent at a time");
+    SELFTEST_EndMove(ARCOMMANDS_ARDRONE3_PILOTINGEVENT_MOVEBYEND_ERROR_OK);
+    SELFTEST_Check((movesSent == 2) && (lastSentDX == 2), "move engine: next move sent on moveByEnd");
+    SELFTEST_EndMove(ARCOMMANDS_ARDRONE3_PILOTINGEVENT_MOVEBYEND_ERROR_OK);
+    SELFTEST_Check((MOVEENGINE_WaitIdle(0) == 0) && (movesEnded == 2), "move engine: idle once all moves ended");
+
+    // a refused move drops the moves queued behind it
+    MOVEENGINE_QueueMove(3, 0, 0, 0, NULL);
+    MOVEENGINE_QueueMove(4, 0, 0, 0, NULL);
+    SELFTEST_EndMove(ARCOMMANDS_ARDRONE3_PILOTINGEVENT_MOVEBYEND_ERROR_BUSY);
+    SELFTEST_Check((movesSent == 3) && (MOVEENGINE_WaitIdle(0) == 0), "move engine: busy moveByEnd drops the queue");
+
+    // abort: the new move waits for the moveByEnd of the abandoned one
+    MOVEENGINE_QueueMove(5, 0, 0, 0, NULL);
+    MOVEENGINE_QueueMove(6, 0, 0, 0, NULL);
+    movesInterrupted = 0;
+    MOVEENGINE_Abort();
+    SELFTEST_Check(movesInterrupted == 2, "move engine: abort reports the current and pending moves");
+    MOVEENGINE_QueueMove(7, 0, 0, 0, NULL);
+    SELFTEST_Check(movesSent == 4, "move engine: new move held behind the abandoned one");
+    SELFTEST_EndMove(ARCOMMANDS_ARDRONE3_PILOTINGEVENT_MOVEBYEND_ERROR_INTERRUPTED);
+    SELFTEST_Check((movesSent == 5) && (lastSentDX == 7), "move engine: held move sent once the abandoned one ended");
+    SELFTEST_EndMove(ARCOMMANDS_ARDRONE3_PILOTINGEVENT_MOVEBYEND_ERROR_OK);
+
+    MOVEENGINE_Destroy();
+    SELFTEST_Check(MOVEENGINE_QueueMove(8, 0, 0, 0, NULL) != 0, "move engine: no move queued after destroy");
+}
+
+static eARCONTROLLER_ERROR SELFTEST_SendMoveBy (ARCONTROLLER_FEATURE_ARDrone3_t *feature, float dX, float dY, float dZ, float dPsi)
+{
+    movesSent++;
+    lastSentDX = dX;
+    return ARCONTROLLER_OK;
+}
+
+static void SELFTEST_MoveEnded (const MOVEENGINE_Move_t *move, const MOVEENGINE_Result_t *result, void *customData)
+{
+    movesEnded++;
+    if (result->error == ARCOMMANDS_ARDRONE3_PILOTINGEVENT_MOVEBYEND_ERROR_INTERRUPTED)
+    {
+        movesInterrupted++;
+    }
+}
+
+// give the move engine a moveByEnd like the device controller does
+static void SELFTEST_EndMove (eARCOMMANDS_ARDRONE3_PILOTINGEVENT_MOVEBYEND_ERROR error)
+{
+    ARCONTROLLER_DICTIONARY_ELEMENT_t *elementDictionary = NULL;
+    ARCONTROLLER_DICTIONARY_ELEMENT_t element;
+    ARCONTROLLER_DICTIONARY_ARG_t arg;
+
+    memset(&element, 0, sizeof(element));
+    memset(&arg, 0, sizeof(arg));
+    element.key = ARCONTROLLER_DICTIONARY_SINGLE_KEY;
+    arg.argument = ARCONTROLLER_DICTIONARY_KEY_ARDRONE3_PILOTINGEVENT_MOVEBYEND_ERROR;
+    arg.valueType = ARCONTROLLER_DICTIONARY_VALUE_TYPE_ENUM;
+    arg.value.I32 = error;
+    HASH_ADD_KEYPTR (hh, element.arguments, arg.argument, strlen(arg.argument), &arg);
+    HASH_ADD_KEYPTR (hh, elementDictionary, element.key, strlen(element.key), &element);
+
+    MOVEENGINE_OnMoveByEnd(elementDictionary);
+
+    HASH_CLEAR (hh, element.arguments);
+    HASH_CLEAR (hh, elementDictionary);
+}
+
+static void SELFTEST_VideoSink (void)
+{
+    VIDEOSINK_Metrics_t metrics;
+    int fds[2] = {-1, -1};
+    uint8_t buffer[4096];
+    ssize_t readSize = 0;
+    ssize_t expectedSize = 0;
+    ssize_t totalRead = 0;
+    uint32_t skipped = 0;
+    int rows = 0;
+    FILE *metaFile = NULL;
+
+    if (pipe(fds) != 0)
+    {
+        SELFTEST_Check(0, "video sink: pipe");
+        return;
+    }
+
+    if ((VIDEOSINK_Init(fds[1], SELFTEST_VIDEO_QUEUE_SIZE) != 0) || (FRAMEMETA_Init(SELFTEST_VIDEO_FRAMES * 2) != 0))
+    {
+        SELFTEST_Check(0, "video sink: init");
+        close(fds[0]);
+        close(fds[1]);
+        return;
+    }
+    VIDEOSINK_SetFrameCallback(FRAMEMETA_ProcessFrame, NULL);
+
+    // nobody reads: the pipe and the queue fill up, then the P-frames reference a dropped frame
+    SELFTEST_PushVideoFrames(2 * SELFTEST_VIDEO_QUEUE_SIZE, 0);
+    usleep(50000);
+    VIDEOSINK_GetMetrics(&metrics);
+    SELFTEST_Check(metrics.maxDepth <= SELFTEST_VIDEO_QUEUE_SIZE, "video sink: queue depth bounded by its size");
+    SELFTEST_Check(metrics.droppedFull > 0, "video sink: frames dropped when the queue is full");
+    SELFTEST_Check(metrics.droppedSkip > 0, "video sink: P-frames after a drop skipped");
+
+    // the next I-frame ends the skip
+    skipped = metrics.droppedSkip;
+    SELFTEST_PushVideoFrames(2, 1);
+    VIDEOSINK_GetMetrics(&metrics);
+    SELFTEST_Check(metrics.droppedSkip == skipped, "video sink: writes restart from an I-frame");
+
+    // every frame kept is written once the reader drains the pipe
+    expectedSize = (ssize_t)(metrics.received - metrics.droppedFull - metrics.droppedSkip - metrics.flushed) * SELFTEST_VIDEO_FRAME_SIZE;
+    while ((totalRead < expectedSize) && ((readSize = read(fds[0], buffer, sizeof(buffer))) > 0))
+    {
+        totalRead += readSize;
+    }
+    usleep(50000);
+    VIDEOSINK_GetMetrics(&metrics);
+    SELFTEST_Check((totalRead == expectedSize) && (metrics.written * SELFTEST_VIDEO_FRAME_SIZE == expectedSize), "video sink: queued frames written");
+
+    // reader gone: the frames are counted as write errors, nothing blocks
+    close(fds[0]);
+    SELFTEST_PushVideoFrames(SELFTEST_VIDEO_FRAMES - metrics.received, SELFTEST_VIDEO_I_FRAME_PERIOD);
+    usleep(50000);
+    VIDEOSINK_GetMetrics(&metrics);
+    SELFTEST_Check(metrics.received == SELFTEST_VIDEO_FRAMES, "video sink: every frame received");
+    SELFTEST_Check(metrics.written + metrics.droppedSkip + metrics.droppedFull + metrics.flushed + metrics.writeErrors == metrics.received,
+                   "video sink: every frame written or dropped once");
+    SELFTEST_Check(metrics.writeErrors > 0, "video sink: closed reader counted as write errors");
+
+    VIDEOSINK_Destroy();
+    close(fds[1]);
+
+    // one metadata row per frame, written or dropped
+    metaFile = tmpfile();
+    if (metaFile != NULL)
+    {
+        rows = FRAMEMETA_WriteCsv(metaFile);
+        fclose(metaFile);
+    }
+    SELFTEST_Check(rows == SELFTEST_VIDEO_FRAMES, "frame metadata: one row per frame");
+    FRAMEMETA_Destroy();
+}
+
+// push annex B frames made of a single slice NAL unit, starting with an I-frame ; iFramePeriod 0 for a single I-frame
+static void SELFTEST_PushVideoFrames (int count, int iFramePeriod)
+{
+    static uint8_t data[SELFTEST_VIDEO_FRAME_SIZE];
+    ARCONTROLLER_Frame_t frame;
+    int i = 0;
+
+    memset(&frame, 0, sizeof(frame));
+    frame.data = data;
+    frame.used = SELFTEST_VIDEO_FRAME_SIZE;
+    frame.capacity = SELFTEST_VIDEO_FRAME_SIZE;
+    data[3] = 1;
+
+    for (i = 0; i < count; i++)
+    {
+        frame.isIFrame = ((i == 0) || ((iFramePeriod > 0) && (i % iFramePeriod == 0)));
+        data[4] = frame.isIFrame ? 0x65 : 0x41;
+        VIDEOSINK_PushFrame(&frame);
+    }
+}
+
+static void SELFTEST_Mission (void)
+{
+    if (STATE_Init() != 0)
+    {
+        SELFTEST_Check(0, "mission: init");
+        return;
+    }
+
+    SELFTEST_Check(SELFTEST_RunMission("takeoff\nforward 1\nturn 90\nland\n") == 0, "mission: simulated mission flown");
+    SELFTEST_Check(SELFTEST_RunMission("forward 1\nland\n") != 0, "mission: move refused on the ground aborts the mission");
+    SELFTEST_Check(SELFTEST_RunMission("wait 2.5e9\n") == -2, "mission: too long wait rejected");
+
+    STATE_Destroy();
+}
+
+// fly a mission on the simulated Bebop ; -2 if it can not be loaded
+static int SELFTEST_RunMission (const char *text)
+{
+    char fileName[] = SELFTEST_MISSION_FILE_TEMPLATE;
+    ARCONTROLLER_Device_t *deviceController = NULL;
+    MISSION_t *mission = NULL;
+    FILE *file = NULL;
+    int fd = -1;
+    int ret = -2;
+
+    fd = mkstemp(fileName);
+    if (fd >= 0)
+    {
+        file = fdopen(fd, "w");
+    }
+    if (file == NULL)
+    {
+        if (fd >= 0)
+        {
+            close(fd);
+        }
+        return -1;
+    }
+    fputs(text, file);
+    fclose(file);
+
+    mission = MISSION_New();
+    if ((mission != NULL) && (MISSION_LoadFile(mission, fileName) == 0))
+    {
+        ret = -1;
+        deviceController = SIMULATOR_New(SELFTEST_SimulatorCommand, NULL);
+        if ((deviceController != NULL) && (MOVEENGINE_Init(deviceController, NULL, NULL) == 0))
+        {
+            if ((MISSION_Start(mission, deviceController) == 0) && (MISSION_Wait(mission) == 0))
+            {
+                ret = 0;
+            }
+            MOVEENGINE_Destroy();
+        }
+        SIMULATOR_Delete(&deviceController);
+    }
+
+    MISSION_Delete(&mission);
+    unlink(fileName);
+
+    return ret;
+}
+
+static void SELFTEST_SimulatorCommand (eARCONTROLLER_DICTIONARY_KEY commandKey, ARCONTROLLER_DICTIONARY_ELEMENT_t *elementDictionary, void *customData)
+{
+    STATE_Update(commandKey, elementDictionary);
+    if (commandKey == ARCONTROLLER_DICTIONARY_KEY_ARDRONE3_PILOTINGEVENT_MOVEBYEND)
+    {
+        MOVEENGINE_OnMoveByEnd(elementDictionary);
+    }
+}
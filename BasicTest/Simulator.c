@@ -0,0 +1,515 @@
+/**
+ * @file Simulator.c
+ * @brief This file contains sources about the simulated Bebop
+ * @date 19/10/2026
+ *
+ * The simulated drone executes one action at a time (take off, landing or relative move), with a
+ * duration derived from the SIMULATOR_* speeds, and reports it with the same events as a real drone.
+ */
+
+/*****************************************
+ *
+ *             include file :
+ *
+ *****************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include <libARSAL/ARSAL.h>
+#include <libARController/ARController.h>
+
+#include "Simulator.h"
+
+/*****************************************
+ *
+ *             define :
+ *
+ *****************************************/
+#define TAG "Simulator"
+
+#define SIMULATOR_COMMAND_QUEUE_SIZE 16
+#define SIMULATOR_MAX_EVENTS 8
+#define SIMULATOR_IDLE_WAIT_MS 100
+
+/*****************************************
+ *
+ *             private header:
+ *
+ ****************************************/
+
+typedef enum
+{
+    SIMULATOR_ACTION_TAKEOFF = 0,
+    SIMULATOR_ACTION_LANDING,
+    SIMULATOR_ACTION_MOVEBY,
+    SIMULATOR_ACTION_EMERGENCY,
+} eSIMULATOR_ACTION;
+
+/**
+ * @brief Command sent to the simulated drone, or action in progress
+ */
+typedef struct
+{
+    eSIMULATOR_ACTION action;
+    struct timespec time; /**< processing time for a command, end time for an action */
+    float dX;
+    float dY;
+    float dZ;
+    float dPsi;
+} SIMULATOR_Command_t;
+
+/**
+ * @brief Event to give to the command callback once the lock is released
+ */
+typedef struct
+{
+    eARCONTROLLER_DICTIONARY_KEY commandKey;
+    eARCOMMANDS_ARDRONE3_PILOTINGSTATE_FLYINGSTATECHANGED_STATE state;
+    float dX;
+    float dY;
+    float dZ;
+    float dPsi;
+    eARCOMMANDS_ARDRONE3_PILOTINGEVENT_MOVEBYEND_ERROR error;
+} SIMULATOR_Event_t;
+
+static eARCONTROLLER_ERROR SIMULATOR_SendTakeOff (ARCONTROLLER_FEATURE_ARDrone3_t *feature);
+static eARCONTROLLER_ERROR SIMULATOR_SendLanding (ARCONTROLLER_FEATURE_ARDrone3_t *feature);
+static eARCONTROLLER_ERROR SIMULATOR_SendEmergency (ARCONTROLLER_FEATURE_ARDrone3_t *feature);
+static eARCONTROLLER_ERROR SIMULATOR_SendMoveBy (ARCONTROLLER_FEATURE_ARDrone3_t *feature, float dX, float dY, float dZ, float dPsi);
+static eARCONTROLLER_ERROR SIMULATOR_PushCommand (eSIMULATOR_ACTION action, float dX, float dY, float dZ, float dPsi);
+static void *SIMULATOR_Run (void *data);
+static void SIMULATOR_Process (const SIMULATOR_Command_t *command, const struct timespec *now, SIMULATOR_Event_t *events, int *eventCount);
+static void SIMULATOR_EndAction (SIMULATOR_Event_t *events, int *eventCount);
+static void SIMULATOR_SetState (eARCOMMANDS_ARDRONE3_PILOTINGSTATE_FLYINGSTATECHANGED_STATE state, SIMULATOR_Event_t *events, int *eventCount);
+static void SIMULATOR_AddMoveByEnd (const SIMULATOR_Command_t *move, eARCOMMANDS_ARDRONE3_PILOTINGEVENT_MOVEBYEND_ERROR error, SIMULATOR_Event_t *events, int *eventCount);
+static void SIMULATOR_Notify (const SIMULATOR_Event_t *event);
+static void SIMULATOR_AddMs (struct timespec *time, int ms);
+static int SIMULATOR_IsFlying (void);
+
+/*****************************************
+ *
+ *             implementation :
+ *
+ *****************************************/
+
+static ARCONTROLLER_Device_t *simDevice = NULL;
+static ARCONTROLLER_DICTIONARY_CALLBACK_t simCallback = NULL;
+static void *simCustomData = NULL;
+static ARSAL_Thread_t simThread = NULL;
+static ARSAL_Mutex_t simMutex;
+static ARSAL_Cond_t simCond;
+static int simRun = 0;
+
+static SIMULATOR_Command_t commands[SIMULATOR_COMMAND_QUEUE_SIZE];
+static int commandHead = 0;
+static int commandCount = 0;
+static SIMULATOR_Command_t currentAction;
+static int currentActionValid = 0;
+static eARCOMMANDS_ARDRONE3_PILOTINGSTATE_FLYINGSTATECHANGED_STATE flyingState = ARCOMMANDS_ARDRONE3_PILOTINGSTATE_FLYINGSTATECHANGED_STATE_LANDED;
+
+ARCONTROLLER_Device_t *SIMULATOR_New (ARCONTROLLER_DICTIONARY_CALLBACK_t commandCallback, void *customData)
+{
+    int failed = 0;
+
+    if ((commandCallback == NULL) || (simDevice != NULL))
+    {
+        return NULL;
+    }
+
+    simDevice = calloc(1, sizeof(ARCONTROLLER_Device_t));
+    if (simDevice != NULL)
+    {
+        simDevice->aRDrone3 = calloc(1, sizeof(ARCONTROLLER_FEATURE_ARDrone3_t));
+    }
+
+    if ((simDevice == NULL) || (simDevice->aRDrone3 == NULL))
+    {
+        failed = 1;
+    }
+
+    if (!failed)
+    {
+        simDevice->aRDrone3->sendPilotingTakeOff = SIMULATOR_SendTakeOff;
+        simDevice->aRDrone3->sendPilotingLanding = SIMULATOR_SendLanding;
+        simDevice->aRDrone3->sendPilotingEmergency = SIMULATOR_SendEmergency;
+        simDevice->aRDrone3->sendPilotingMoveBy = SIMULATOR_SendMoveBy;
+
+        simCallback = commandCallback;
+        simCustomData = customData;
+        commandHead = 0;
+        commandCount = 0;
+        currentActionValid = 0;
+        flyingState = ARCOMMANDS_ARDRONE3_PILOTINGSTATE_FLYINGSTATECHANGED_STATE_LANDED;
+        simRun = 1;
+
+        ARSAL_Mutex_Init(&simMutex);
+        ARSAL_Cond_Init(&simCond);
+
+        if (ARSAL_Thread_Create(&simThread, SIMULATOR_Run, NULL) != 0)
+        {
+            ARSAL_PRINT(ARSAL_PRINT_ERROR, TAG, "Creation of simulator thread failed.");
+            ARSAL_Cond_Destroy(&simCond);
+            ARSAL_Mutex_Destroy(&simMutex);
+            simThread = NULL;
+            failed = 1;
+        }
+    }
+
+    if (failed)
+    {
+        if (simDevice != NULL)
+        {
+            free(simDevice->aRDrone3);
+            free(simDevice);
+            simDevice = NULL;
+        }
+    }
+
+    return simDevice;
+}
+
+void SIMULATOR_Delete (ARCONTROLLER_Device_t **deviceController)
+{
+    if ((deviceController == NULL) || (*deviceController == NULL) || (*deviceController != simDevice))
+    {
+        return;
+    }
+
+    ARSAL_Mutex_Lock(&simMutex);
+    simRun = 0;
+    ARSAL_Cond_Signal(&simCond);
+    ARSAL_Mutex_Unlock(&simMutex);
+
+    ARSAL_Thread_Join(simThread, NULL);
+    ARSAL_Thread_Destroy(&simThread);
+    simThread = NULL;
+
+    ARSAL_Cond_Destroy(&simCond);
+    ARSAL_Mutex_Destroy(&simMutex);
+
+    free(simDevice->aRDrone3);
+    free(simDevice);
+    simDevice = NULL;
+    *deviceController = NULL;
+}
+
+/*****************************************
+ *
+ *             private implementation:
+ *
+ ****************************************/
+
+static eARCONTROLLER_ERROR SIMULATOR_SendTakeOff (ARCONTROLLER_FEATURE_ARDrone3_t *feature)
+{
+    return SIMULATOR_PushCommand(SIMULATOR_ACTION_TAKEOFF, 0, 0, 0, 0);
+}
+
+static eARCONTROLLER_ERROR SIMULATOR_SendLanding (ARCONTROLLER_FEATURE_ARDrone3_t *feature)
+{
+    return SIMULATOR_PushCommand(SIMULATOR_ACTION_LANDING, 0, 0, 0, 0);
+}
+
+static eARCONTROLLER_ERROR SIMULATOR_SendEmergency (ARCONTROLLER_FEATURE_ARDrone3_t *feature)
+{
+    return SIMULATOR_PushCommand(SIMULATOR_ACTION_EMERGENCY, 0, 0, 0, 0);
+}
+
+static eARCONTROLLER_ERROR SIMULATOR_SendMoveBy (ARCONTROLLER_FEATURE_ARDrone3_t *feature, float dX, float dY, float dZ, float dPsi)
+{
+    return SIMULATOR_PushCommand(SIMULATOR_ACTION_MOVEBY, dX, dY, dZ, dPsi);
+}
+
+static eARCONTROLLER_ERROR SIMULATOR_PushCommand (eSIMULATOR_ACTION action, float dX, float dY, float dZ, float dPsi)
+{
+    SIMULATOR_Command_t *command = NULL;
+    eARCONTROLLER_ERROR error = ARCONTROLLER_OK;
+
+    ARSAL_Mutex_Lock(&simMutex);
+
+    if (commandCount >= SIMULATOR_COMMAND_QUEUE_SIZE)
+    {
+        error = ARCONTROLLER_ERROR_BUFFER_SIZE;
+    }
+    else
+    {
+        command = &(commands[(commandHead + commandCount) % SIMULATOR_COMMAND_QUEUE_SIZE]);
+        command->action = action;
+        command->dX = dX;
+        command->dY = dY;
+        command->dZ = dZ;
+        command->dPsi = dPsi;
+        clock_gettime(CLOCK_MONOTONIC, &(command->time));
+        SIMULATOR_AddMs(&(command->time), SIMULATOR_LATENCY_MS);
+        commandCount++;
+
+        ARSAL_Cond_Signal(&simCond);
+    }
+
+    ARSAL_Mutex_Unlock(&simMutex);
+
+    return error;
+}
+
+static void *SIMULATOR_Run (void *data)
+{
+    SIMULATOR_Event_t events[SIMULATOR_MAX_EVENTS * SIMULATOR_COMMAND_QUEUE_SIZE];
+    struct timespec now;
+    int eventCount = 0;
+    int waitMs = 0;
+    int i = 0;
+
+    ARSAL_Mutex_Lock(&simMutex);
+
+    while (simRun)
+    {
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        eventCount = 0;
+
+        // commands reaching the drone
+        while ((commandCount > 0) && (ARSAL_Time_ComputeTimespecMsTimeDiff(&(commands[commandHead].time), &now) >= 0))
+        {
+            SIMULATOR_Process(&(commands[commandHead]), &now, events, &eventCount);
+            commandHead = (commandHead + 1) % SIMULATOR_COMMAND_QUEUE_SIZE;
+            commandCount--;
+        }
+
+        // action ended
+        if ((currentActionValid) && (ARSAL_Time_ComputeTimespecMsTimeDiff(&(currentAction.time), &now) >= 0))
+        {
+            SIMULATOR_EndAction(events, &eventCount);
+        }
+
+        if (eventCount > 0)
+        {
+            // the callback can send a new command
+            ARSAL_Mutex_Unlock(&simMutex);
+            for (i = 0; i < eventCount; i++)
+            {
+                SIMULATOR_Notify(&(events[i]));
+            }
+            ARSAL_Mutex_Lock(&simMutex);
+            continue;
+        }
+
+        waitMs = SIMULATOR_IDLE_WAIT_MS;
+        if (commandCount > 0)
+        {
+            waitMs = ARSAL_Time_ComputeTimespecMsTimeDiff(&now, &(commands[commandHead].time));
+        }
+        if ((currentActionValid) && (ARSAL_Time_ComputeTimespecMsTimeDiff(&now, &(currentAction.time)) < waitMs))
+        {
+            waitMs = ARSAL_Time_ComputeTimespecMsTimeDiff(&now, &(currentAction.time));
+        }
+
+        if (waitMs > 0)
+        {
+            ARSAL_Cond_Timedwait(&simCond, &simMutex, waitMs);
+        }
+    }
+
+    ARSAL_Mutex_Unlock(&simMutex);
+
+    return NULL;
+}
+
+// must be called with simMutex locked
+static void SIMULATOR_Process (const SIMULATOR_Command_t *command, const struct timespec *now, SIMULATOR_Event_t *events, int *eventCount)
+{
+    float horizontalMs = 0;
+    float verticalMs = 0;
+    float rotationMs = 0;
+    float durationMs = 0;
+
+    switch (command->action)
+    {
+    case SIMULATOR_ACTION_TAKEOFF:
+        if (flyingState == ARCOMMANDS_ARDRONE3_PILOTINGSTATE_FLYINGSTATECHANGED_STATE_LANDED)
+        {
+            currentAction = *command;
+            currentAction.time = *now;
+            SIMULATOR_AddMs(&(currentAction.time), SIMULATOR_TAKEOFF_MS);
+            currentActionValid = 1;
+            SIMULATOR_SetState(ARCOMMANDS_ARDRONE3_PILOTINGSTATE_FLYINGSTATECHANGED_STATE_TAKINGOFF, events, eventCount);
+        }
+        break;
+
+    case SIMULATOR_ACTION_LANDING:
+        if (SIMULATOR_IsFlying())
+        {
+            if ((currentActionValid) && (currentAction.action == SIMULATOR_ACTION_MOVEBY))
+            {
+                SIMULATOR_AddMoveByEnd(&currentAction, ARCOMMANDS_ARDRONE3_PILOTINGEVENT_MOVEBYEND_ERROR_INTERRUPTED, events, eventCount);
+            }
+            currentAction = *command;
+            currentAction.time = *now;
+            SIMULATOR_AddMs(&(currentAction.time), SIMULATOR_LANDING_MS);
+            currentActionValid = 1;
+            SIMULATOR_SetState(ARCOMMANDS_ARDRONE3_PILOTINGSTATE_FLYINGSTATECHANGED_STATE_LANDING, events, eventCount);
+        }
+        break;
+
+    case SIMULATOR_ACTION_EMERGENCY:
+        if ((currentActionValid) && (currentAction.action == SIMULATOR_ACTION_MOVEBY))
+        {
+            SIMULATOR_AddMoveByEnd(&currentAction, ARCOMMANDS_ARDRONE3_PILOTINGEVENT_MOVEBYEND_ERROR_INTERRUPTED, events, eventCount);
+        }
+        currentActionValid = 0;
+        SIMULATOR_SetState(ARCOMMANDS_ARDRONE3_PILOTINGSTATE_FLYINGSTATECHANGED_STATE_EMERGENCY, events, eventCount);
+        SIMULATOR_SetState(ARCOMMANDS_ARDRONE3_PILOTINGSTATE_FLYINGSTATECHANGED_STATE_LANDED, events, eventCount);
+        break;
+
+    case SIMULATOR_ACTION_MOVEBY:
+        if (!SIMULATOR_IsFlying())
+        {
+            SIMULATOR_AddMoveByEnd(command, ARCOMMANDS_ARDRONE3_PILOTINGEVENT_MOVEBYEND_ERROR_BUSY, events, eventCount);
+            break;
+        }
+
+        if ((currentActionValid) && (currentAction.action == SIMULATOR_ACTION_MOVEBY))
+        {
+            // a new move replaces the current one
+            SIMULATOR_AddMoveByEnd(&currentAction, ARCOMMANDS_ARDRONE3_PILOTINGEVENT_MOVEBYEND_ERROR_INTERRUPTED, events, eventCount);
+        }
+
+        horizontalMs = sqrtf(command->dX * command->dX + command->dY * command->dY) * 1000 / SIMULATOR_SPEED;
+        verticalMs = fabsf(command->dZ) * 1000 / SIMULATOR_VERTICAL_SPEED;
+        rotationMs = fabsf(command->dPsi) * 1000 / SIMULATOR_ROTATION_SPEED;
+        durationMs = fmaxf(horizontalMs, fmaxf(verticalMs, rotationMs));
+
+        currentAction = *command;
+        currentAction.time = *now;
+        SIMULATOR_AddMs(&(currentAction.time), (int)durationMs);
+        currentActionValid = 1;
+        SIMULATOR_SetState(ARCOMMANDS_ARDRONE3_PILOTINGSTATE_FLYINGSTATECHANGED_STATE_FLYING, events, eventCount);
+        break;
+
+    default:
+        break;
+    }
+}
+
+// must be called with simMutex locked
+static void SIMULATOR_EndAction (SIMULATOR_Event_t *events, int *eventCount)
+{
+    currentActionValid = 0;
+
+    switch (currentAction.action)
+    {
+    case SIMULATOR_ACTION_TAKEOFF:
+        SIMULATOR_SetState(ARCOMMANDS_ARDRONE3_PILOTINGSTATE_FLYINGSTATECHANGED_STATE_HOVERING, events, eventCount);
+        break;
+
+    case SIMULATOR_ACTION_LANDING:
+        SIMULATOR_SetState(ARCOMMANDS_ARDRONE3_PILOTINGSTATE_FLYINGSTATECHANGED_STATE_LANDED, events, eventCount);
+        break;
+
+    case SIMULATOR_ACTION_MOVEBY:
+        SIMULATOR_AddMoveByEnd(&currentAction, ARCOMMANDS_ARDRONE3_PILOTINGEVENT_MOVEBYEND_ERROR_OK, events, eventCount);
+        SIMULATOR_SetState(ARCOMMANDS_ARDRONE3_PILOTINGSTATE_FLYINGSTATECHANGED_STATE_HOVERING, events, eventCount);
+        break;
+
+    default:
+        break;
+    }
+}
+
+static void SIMULATOR_SetState (eARCOMMANDS_ARDRONE3_PILOTINGSTATE_FLYINGSTATECHANGED_STATE state, SIMULATOR_Event_t *events, int *eventCount)
+{
+    SIMULATOR_Event_t *event = &(events[(*eventCount)++]);
+
+    flyingState = state;
+
+    memset(event, 0, sizeof(*event));
+    event->commandKey = ARCONTROLLER_DICTIONARY_KEY_ARDRONE3_PILOTINGSTATE_FLYINGSTATECHANGED;
+    event->state = state;
+}
+
+static void SIMULATOR_AddMoveByEnd (const SIMULATOR_Command_t *move, eARCOMMANDS_ARDRONE3_PILOTINGEVENT_MOVEBYEND_ERROR error, SIMULATOR_Event_t *events, int *eventCount)
+{
+    SIMULATOR_Event_t *event = &(events[(*eventCount)++]);
+
+    memset(event, 0, sizeof(*event));
+    event->commandKey = ARCONTROLLER_DICTIONARY_KEY_ARDRONE3_PILOTINGEVENT_MOVEBYEND;
+    event->error = error;
+
+    if (error == ARCOMMANDS_ARDRONE3_PILOTINGEVENT_MOVEBYEND_ERROR_OK)
+    {
+        event->dX = move->dX;
+        event->dY = move->dY;
+        event->dZ = move->dZ;
+        event->dPsi = move->dPsi;
+    }
+}
+
+// build the element dictionary the way the device controller does and give it to the callback
+static void SIMULATOR_Notify (const SIMULATOR_Event_t *event)
+{
+    ARCONTROLLER_DICTIONARY_ELEMENT_t *elementDictionary = NULL;
+    ARCONTROLLER_DICTIONARY_ELEMENT_t element;
+    ARCONTROLLER_DICTIONARY_ARG_t args[5];
+    int argCount = 0;
+    int i = 0;
+
+    memset(&element, 0, sizeof(element));
+    memset(args, 0, sizeof(args));
+    element.key = ARCONTROLLER_DICTIONARY_SINGLE_KEY;
+
+    if (event->commandKey == ARCONTROLLER_DICTIONARY_KEY_ARDRONE3_PILOTINGSTATE_FLYINGSTATECHANGED)
+    {
+        args[0].argument = ARCONTROLLER_DICTIONARY_KEY_ARDRONE3_PILOTINGSTATE_FLYINGSTATECHANGED_STATE;
+        args[0].valueType = ARCONTROLLER_DICTIONARY_VALUE_TYPE_ENUM;
+        args[0].value.I32 = event->state;
+        argCount = 1;
+    }
+    else
+    {
+        args[0].argument = ARCONTROLLER_DICTIONARY_KEY_ARDRONE3_PILOTINGEVENT_MOVEBYEND_DX;
+        args[0].value.Float = event->dX;
+        args[1].argument = ARCONTROLLER_DICTIONARY_KEY_ARDRONE3_PILOTINGEVENT_MOVEBYEND_DY;
+        args[1].value.Float = event->dY;
+        args[2].argument = ARCONTROLLER_DICTIONARY_KEY_ARDRONE3_PILOTINGEVENT_MOVEBYEND_DZ;
+        args[2].value.Float = event->dZ;
+        args[3].argument = ARCONTROLLER_DICTIONARY_KEY_ARDRONE3_PILOTINGEVENT_MOVEBYEND_DPSI;
+        args[3].value.Float = event->dPsi;
+        for (i = 0; i < 4; i++)
+        {
+            args[i].valueType = ARCONTROLLER_DICTIONARY_VALUE_TYPE_FLOAT;
+        }
+        args[4].argument = ARCONTROLLER_DICTIONARY_KEY_ARDRONE3_PILOTINGEVENT_MOVEBYEND_ERROR;
+        args[4].valueType = ARCONTROLLER_DICTIONARY_VALUE_TYPE_ENUM;
+        args[4].value.I32 = event->error;
+        argCount = 5;
+    }
+
+    for (i = 0; i < argCount; i++)
+    {
+        HASH_ADD_KEYPTR (hh, element.arguments, args[i].argument, strlen(args[i].argument), &(args[i]));
+    }
+    HASH_ADD_KEYPTR (hh, elementDictionary, element.key, strlen(element.key), &element);
+
+    simCallback(event->commandKey, elementDictionary, simCustomData);
+
+    HASH_CLEAR (hh, element.arguments);
+    HASH_CLEAR (hh, elementDictionary);
+}
+
+static void SIMULATOR_AddMs (struct timespec *time, int ms)
+{
+    time->tv_sec += ms / 1000;
+    time->tv_nsec += (long)(ms % 1000) * 1000000L;
+    if (time->tv_nsec >= 1000000000L)
+    {
+        time->tv_sec++;
+        time->tv_nsec -= 1000000000L;
+    }
+}
+
+// must be called with simMutex locked
+static int SIMULATOR_IsFlying (void)
+{
+    return ((flyingState == ARCOMMANDS_ARDRONE3_PILOTINGSTATE_FLYINGSTATECHANGED_STATE_HOVERING) ||
+            (flyingState == ARCOMMANDS_ARDRONE3_PILOTINGSTATE_FLYINGSTATECHANGED_STATE_FLYING));
+}
@@ -0,0 +1,38 @@
+/**
+ * @file Simulator.h
+ * @brief Simulated Bebop, used to time a mission without a drone
+ * @date 19/10/2026
+ */
+
+#ifndef _SIMULATOR_H_
+#define _SIMULATOR_H_
+
+#include <libARController/ARController.h>
+
+#define SIMULATOR_SPEED 1.5 /**< Horizontal speed in m/s, half of VMAX like the PCMD moves */
+#define SIMULATOR_VERTICAL_SPEED 1.0 /**< Vertical speed in m/s */
+#define SIMULATOR_ROTATION_SPEED 1.57 /**< Rotation speed in rad/s */
+#define SIMULATOR_TAKEOFF_MS 3000 /**< Duration of a take off */
+#define SIMULATOR_LANDING_MS 3000 /**< Duration of a landing */
+#define SIMULATOR_LATENCY_MS 20 /**< Time between the sending of a command and its processing by the drone */
+
+/**
+ * @brief Create a simulated device
+ * @warning This function allocate memory
+ * @post SIMULATOR_Delete() must be called
+ * @note Only aRDrone3->sendPilotingTakeOff, sendPilotingLanding, sendPilotingEmergency and sendPilotingMoveBy are available ;
+ * the simulator answers with FlyingStateChanged and MoveByEnd events given to commandCallback, from its own thread.
+ * @param[in] commandCallback Callback called for each event of the simulated drone, like ARCONTROLLER_Device_AddCommandReceivedCallback()
+ * @param[in] customData Data given to the callback
+ * @return the simulated device or NULL on error
+ */
+ARCONTROLLER_Device_t *SIMULATOR_New (ARCONTROLLER_DICTIONARY_CALLBACK_t commandCallback, void *customData);
+
+/**
+ * @brief Stop and delete a simulated device
+ * @warning This function free memory
+ * @param deviceController Address of the simulated device
+ */
+void SIMULATOR_Delete (ARCONTROLLER_Device_t **deviceController);
+
+#endif /* _SIMULATOR_H_ */
@@ -0,0 +1,249 @@
+/**
+ * @file State.c
+ * @brief This file contains sources about the typed snapshot of the drone state
+ * @date 19/10/2026
+ *
+ * The state is published with a sequence lock: the writer makes the sequence odd while it copies
+ * the new state, readers retry their copy until they read the same even sequence before and after.
+ * Readers therefore never take a lock and can not delay the thread receiving the commands.
+ */
+
+/*****************************************
+ *
+ *             include file :
+ *
+ *****************************************/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <libARSAL/ARSAL.h>
+#include <libARController/ARController.h>
+
+#include "State.h"
+
+/*****************************************
+ *
+ *             define :
+ *
+ *****************************************/
+#define TAG "State"
+
+/*****************************************
+ *
+ *             private header:
+ *
+ ****************************************/
+
+static ARCONTROLLER_DICTIONARY_ARG_t *STATE_GetArg (ARCONTROLLER_DICTIONARY_ELEMENT_t *elementDictionary, const char *argKey);
+
+/*****************************************
+ *
+ *             implementation :
+ *
+ *****************************************/
+
+static uint32_t stateSeq = 0; // odd while the shared state is written
+static STATE_Snapshot_t sharedState; // state read by the readers
+static STATE_Snapshot_t pendingState; // state built by the writer, protected by writerMutex
+static ARSAL_Mutex_t writerMutex;
+
+int STATE_Init (void)
+{
+    memset(&sharedState, 0, sizeof(sharedState));
+    memset(&pendingState, 0, sizeof(pendingState));
+    __atomic_store_n(&stateSeq, 0, __ATOMIC_RELEASE);
+
+    return ARSAL_Mutex_Init(&writerMutex);
+}
+
+void STATE_Destroy (void)
+{
+    ARSAL_Mutex_Destroy(&writerMutex);
+}
+
+void STATE_Update (eARCONTROLLER_DICTIONARY_KEY commandKey, ARCONTROLLER_DICTIONARY_ELEMENT_t *elementDictionary)
+{
+    ARCONTROLLER_DICTIONARY_ARG_t *arg = NULL;
+    ARCONTROLLER_DICTIONARY_ARG_t *arg2 = NULL;
+    ARCONTROLLER_DICTIONARY_ARG_t *arg3 = NULL;
+    int modified = 0;
+    uint32_t seq = 0;
+
+    if (elementDictionary == NULL)
+    {
+        return;
+    }
+
+    switch (commandKey)
+    {
+    case ARCONTROLLER_DICTIONARY_KEY_COMMON_COMMONSTATE_BATTERYSTATECHANGED:
+    case ARCONTROLLER_DICTIONARY_KEY_ARDRONE3_PILOTINGSTATE_FLYINGSTATECHANGED:
+    case ARCONTROLLER_DICTIONARY_KEY_ARDRONE3_PILOTINGSTATE_ATTITUDECHANGED:
+    case ARCONTROLLER_DICTIONARY_KEY_ARDRONE3_PILOTINGSTATE_SPEEDCHANGED:
+    case ARCONTROLLER_DICTIONARY_KEY_ARDRONE3_PILOTINGSTATE_ALTITUDECHANGED:
+    case ARCONTROLLER_DICTIONARY_KEY_ARDRONE3_PILOTINGSTATE_POSITIONCHANGED:
+    case ARCONTROLLER_DICTIONARY_KEY_ARDRONE3_GPSSETTINGSSTATE_GPSFIXSTATECHANGED:
+        break;
+
+    default:
+        // not part of the snapshot
+        return;
+    }
+
+    ARSAL_Mutex_Lock(&writerMutex);
+
+    switch (commandKey)
+    {
+    case ARCONTROLLER_DICTIONARY_KEY_COMMON_COMMONSTATE_BATTERYSTATECHANGED:
+        arg = STATE_GetArg(elementDictionary, ARCONTROLLER_DICTIONARY_KEY_COMMON_COMMONSTATE_BATTERYSTATECHANGED_PERCENT);
+        if (arg != NULL)
+        {
+            pendingState.battery.percent = arg->value.U8;
+            pendingState.battery.valid = 1;
+            modified = 1;
+        }
+        break;
+
+    case ARCONTROLLER_DICTIONARY_KEY_ARDRONE3_PILOTINGSTATE_FLYINGSTATECHANGED:
+        arg = STATE_GetArg(elementDictionary, ARCONTROLLER_DICTIONARY_KEY_ARDRONE3_PILOTINGSTATE_FLYINGSTATECHANGED_STATE);
+        if (arg != NULL)
+        {
+            pendingState.flyingState.state = arg->value.I32;
+            pendingState.flyingState.valid = 1;
+            modified = 1;
+        }
+        break;
+
+    case ARCONTROLLER_DICTIONARY_KEY_ARDRONE3_PILOTINGSTATE_ATTITUDECHANGED:
+        arg = STATE_GetArg(elementDictionary, ARCONTROLLER_DICTIONARY_KEY_ARDRONE3_PILOTINGSTATE_ATTITUDECHANGED_ROLL);
+        arg2 = STATE_GetArg(elementDictionary, ARCONTROLLER_DICTIONARY_KEY_ARDRONE3_PILOTINGSTATE_ATTITUDECHANGED_PITCH);
+        arg3 = STATE_GetArg(elementDictionary, ARCONTROLLER_DICTIONARY_KEY_ARDRONE3_PILOTINGSTATE_ATTITUDECHANGED_YAW);
+        if ((arg != NULL) && (arg2 != NULL) && (arg3 != NULL))
+        {
+            pendingState.attitude.roll = arg->value.Float;
+            pendingState.attitude.pitch = arg2->value.Float;
+            pendingState.attitude.yaw = arg3->value.Float;
+            pendingState.attitude.valid = 1;
+            modified = 1;
+        }
+        break;
+
+    case ARCONTROLLER_DICTIONARY_KEY_ARDRONE3_PILOTINGSTATE_SPEEDCHANGED:
+        arg = STATE_GetArg(elementDictionary, ARCONTROLLER_DICTIONARY_KEY_ARDRONE3_PILOTINGSTATE_SPEEDCHANGED_SPEEDX);
+        arg2 = STATE_GetArg(elementDictionary, ARCONTROLLER_DICTIONARY_KEY_ARDRONE3_PILOTINGSTATE_SPEEDCHANGED_SPEEDY);
+        arg3 = STATE_GetArg(elementDictionary, ARCONTROLLER_DICTIONARY_KEY_ARDRONE3_PILOTINGSTATE_SPEEDCHANGED_SPEEDZ);
+        if ((arg != NULL) && (arg2 != NULL) && (arg3 != NULL))
+        {
+            pendingState.speed.speedX = arg->value.Float;
+            pendingState.speed.speedY = arg2->value.Float;
+            pendingState.speed.speedZ = arg3->value.Float;
+            pendingState.speed.valid = 1;
+            modified = 1;
+        }
+        break;
+
+    case ARCONTROLLER_DICTIONARY_KEY_ARDRONE3_PILOTINGSTATE_ALTITUDECHANGED:
+        arg = STATE_GetArg(elementDictionary, ARCONTROLLER_DICTIONARY_KEY_ARDRONE3_PILOTINGSTATE_ALTITUDECHANGED_ALTITUDE);
+        if (arg != NULL)
+        {
+            pendingState.altitude.altitude = arg->value.Double;
+            pendingState.altitude.valid = 1;
+            modified = 1;
+        }
+        break;
+
+    case ARCONTROLLER_DICTIONARY_KEY_ARDRONE3_PILOTINGSTATE_POSITIONCHANGED:
+        arg = STATE_GetArg(elementDictionary, ARCONTROLLER_DICTIONARY_KEY_ARDRONE3_PILOTINGSTATE_POSITIONCHANGED_LATITUDE);
+        arg2 = STATE_GetArg(elementDictionary, ARCONTROLLER_DICTIONARY_KEY_ARDRONE3_PILOTINGSTATE_POSITIONCHANGED_LONGITUDE);
+        arg3 = STATE_GetArg(elementDictionary, ARCONTROLLER_DICTIONARY_KEY_ARDRONE3_PILOTINGSTATE_POSITIONCHANGED_ALTITUDE);
+        if ((arg != NULL) && (arg2 != NULL) && (arg3 != NULL))
+        {
+            pendingState.position.latitude = arg->value.Double;
+            pendingState.position.longitude = arg2->value.Double;
+            pendingState.position.altitude = arg3->value.Double;
+            pendingState.position.valid = 1;
+            modified = 1;
+        }
+        break;
+
+    case ARCONTROLLER_DICTIONARY_KEY_ARDRONE3_GPSSETTINGSSTATE_GPSFIXSTATECHANGED:
+        arg = STATE_GetArg(elementDictionary, ARCONTROLLER_DICTIONARY_KEY_ARDRONE3_GPSSETTINGSSTATE_GPSFIXSTATECHANGED_FIXED);
+        if (arg != NULL)
+        {
+            pendingState.position.fixed = arg->value.U8;
+            modified = 1;
+        }
+        break;
+
+    default:
+        break;
+    }
+
+    if (modified)
+    {
+        pendingState.updateCount++;
+        clock_gettime(CLOCK_MONOTONIC, &(pendingState.lastUpdate));
+
+        // publish: odd sequence while copying, even again once the copy is complete
+        seq = __atomic_load_n(&stateSeq, __ATOMIC_RELAXED);
+        __atomic_store_n(&stateSeq, seq + 1, __ATOMIC_RELAXED);
+        __atomic_thread_fence(__ATOMIC_RELEASE);
+        memcpy(&sharedState, &pendingState, sizeof(sharedState));
+        __atomic_store_n(&stateSeq, seq + 2, __ATOMIC_RELEASE);
+    }
+
+    ARSAL_Mutex_Unlock(&writerMutex);
+}
+
+void STATE_GetSnapshot (STATE_Snapshot_t *snapshot)
+{
+    uint32_t seqBefore = 0;
+    uint32_t seqAfter = 0;
+
+    if (snapshot == NULL)
+    {
+        return;
+    }
+
+    do
+    {
+        seqBefore = __atomic_load_n(&stateSeq, __ATOMIC_ACQUIRE);
+        if (seqBefore & 1)
+        {
+            // a write is in progress
+            seqAfter = seqBefore + 1;
+            continue;
+        }
+
+        memcpy(snapshot, &sharedState, sizeof(*snapshot));
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        seqAfter = __atomic_load_n(&stateSeq, __ATOMIC_RELAXED);
+    } while (seqBefore != seqAfter);
+}
+
+/*****************************************
+ *
+ *             private implementation:
+ *
+ ****************************************/
+
+static ARCONTROLLER_DICTIONARY_ARG_t *STATE_GetArg (ARCONTROLLER_DICTIONARY_ELEMENT_t *elementDictionary, const char *argKey)
+{
+    ARCONTROLLER_DICTIONARY_ELEMENT_t *singleElement = NULL;
+    ARCONTROLLER_DICTIONARY_ARG_t *arg = NULL;
+
+    // get the command received in the device controller
+    HASH_FIND_STR (elementDictionary, ARCONTROLLER_DICTIONARY_SINGLE_KEY, singleElement);
+    if (singleElement != NULL)
+    {
+        HASH_FIND_STR (singleElement->arguments, argKey, arg);
+    }
+
+    if (arg == NULL)
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, TAG, "arg %s is NULL", argKey);
+    }
+
+    return arg;
+}
@@ -0,0 +1,118 @@
+/**
+ * @file State.h
+ * @brief Typed snapshot of the drone state, readable from any thread without locking
+ * @date 19/10/2026
+ */
+
+#ifndef _STATE_H_
+#define _STATE_H_
+
+#include <stdint.h>
+#include <time.h>
+
+#include <libARController/ARController.h>
+
+/**
+ * @brief Battery state, from CommonState BatteryStateChanged
+ */
+typedef struct
+{
+    int valid; /**< '1' once the value has been received at least once */
+    uint8_t percent; /**< Battery level in percent */
+} STATE_Battery_t;
+
+/**
+ * @brief Flying state, from PilotingState FlyingStateChanged
+ */
+typedef struct
+{
+    int valid;
+    eARCOMMANDS_ARDRONE3_PILOTINGSTATE_FLYINGSTATECHANGED_STATE state;
+} STATE_FlyingState_t;
+
+/**
+ * @brief Attitude in radian, from PilotingState AttitudeChanged
+ */
+typedef struct
+{
+    int valid;
+    float roll;
+    float pitch;
+    float yaw;
+} STATE_Attitude_t;
+
+/**
+ * @brief Speed in m/s in the NED frame, from PilotingState SpeedChanged
+ */
+typedef struct
+{
+    int valid;
+    float speedX;
+    float speedY;
+    float speedZ;
+} STATE_Speed_t;
+
+/**
+ * @brief Altitude in meters above take off point, from PilotingState AltitudeChanged
+ */
+typedef struct
+{
+    int valid;
+    double altitude;
+} STATE_Altitude_t;
+
+/**
+ * @brief GPS position and fix, from PilotingState PositionChanged and GPSSettingsState GPSFixStateChanged
+ */
+typedef struct
+{
+    int valid;
+    int fixed; /**< '1' if the GPS is fixed */
+    double latitude; /**< 500.0 if not available */
+    double longitude; /**< 500.0 if not available */
+    double altitude;
+} STATE_Position_t;
+
+/**
+ * @brief Consistent copy of the whole drone state
+ */
+typedef struct
+{
+    uint32_t updateCount; /**< Number of commands which modified the state */
+    struct timespec lastUpdate; /**< CLOCK_MONOTONIC time of the last modification */
+    STATE_Battery_t battery;
+    STATE_FlyingState_t flyingState;
+    STATE_Attitude_t attitude;
+    STATE_Speed_t speed;
+    STATE_Altitude_t altitude;
+    STATE_Position_t position;
+} STATE_Snapshot_t;
+
+/**
+ * @brief Initialize the shared state
+ * @post STATE_Destroy() must be called
+ * @return 0 if no error occurred
+ */
+int STATE_Init (void);
+
+/**
+ * @brief Destroy the shared state
+ */
+void STATE_Destroy (void);
+
+/**
+ * @brief Update the shared state from a command received from the drone
+ * @note Must be called from the command received callback ; commands not part of the snapshot are ignored
+ * @param[in] commandKey Key of the command received
+ * @param[in] elementDictionary Element dictionary given to the callback
+ */
+void STATE_Update (eARCONTROLLER_DICTIONARY_KEY commandKey, ARCONTROLLER_DICTIONARY_ELEMENT_t *elementDictionary);
+
+/**
+ * @brief Copy the last published state
+ * @note Lock free: readers never block the thread receiving the commands, they retry if a write happened during the copy
+ * @param[out] snapshot Copy of the state
+ */
+void STATE_GetSnapshot (STATE_Snapshot_t *snapshot);
+
+#endif /* _STATE_H_ */
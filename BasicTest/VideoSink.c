@@ -0,0 +1,664 @@
+/**
+ * @file VideoSink.c
+ * @brief This file contains sources about the video sink
+ * @date 19/10/2026
+ *
+ * The stream thread only copies the frame in one of the buffers allocated at init ; the writer thread
+ * writes the queued frames with one writev() per batch, so a slow player never blocks the stream thread.
+ * The frame given by the device controller is recycled when the callback returns, so it cannot be queued itself.
+ *
+ * The copies are made in buffers of two size classes, carved at init from one mapping (hugepages when available)
+ * which is touched once, so neither a large I-frame nor the first use of a buffer calls the allocator or faults.
+ */
+
+/*****************************************
+ *
+ *             include file :
+ *
+ *****************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/uio.h>
+#include <sys/mman.h>
+
+#include <libARSAL/ARSAL.h>
+#include <libARController/ARController.h>
+
+#include "VideoSink.h"
+
+/*****************************************
+ *
+ *             define :
+ *
+ *****************************************/
+#define TAG "VideoSink"
+
+#define VIDEOSINK_CONFIG_MAX_SIZE 512
+
+#define VIDEOSINK_HUGEPAGE_SIZE (2 * 1024 * 1024)
+
+/*****************************************
+ *
+ *             private header:
+ *
+ ****************************************/
+
+/**
+ * @brief Size class of a frame buffer
+ */
+typedef enum
+{
+    VIDEOSINK_CLASS_SMALL = 0, /**< VIDEOSINK_SMALL_BUFFER_SIZE, one per slot */
+    VIDEOSINK_CLASS_LARGE, /**< VIDEOSINK_LARGE_BUFFER_SIZE, for the I-frames */
+    VIDEOSINK_CLASS_HEAP, /**< malloc() fallback for a frame no buffer can hold */
+
+    VIDEOSINK_CLASS_MAX,
+} eVIDEOSINK_CLASS;
+
+/**
+ * @brief Copy of a frame received
+ */
+typedef struct
+{
+    uint8_t *data; /**< Buffer holding the frame, NULL when the slot is free */
+    eVIDEOSINK_CLASS bufferClass;
+    uint32_t used;
+    int isIFrame;
+    struct timespec receivedTime;
+    uint32_t frameIndex;
+} VIDEOSINK_Slot_t;
+
+static void *VIDEOSINK_WriterRun (void *data);
+static int VIDEOSINK_WriteAll (struct iovec *iov, int iovCount);
+static int VIDEOSINK_CreateSlab (int frameCount);
+static void VIDEOSINK_DeleteSlab (void);
+static int VIDEOSINK_AcquireBuffer (VIDEOSINK_Slot_t *slot, uint32_t size);
+static void VIDEOSINK_ReleaseBuffer (VIDEOSINK_Slot_t *slot);
+static void VIDEOSINK_DropQueued (void);
+
+/*****************************************
+ *
+ *             implementation :
+ *
+ *****************************************/
+
+static int sinkFd = -1;
+static int sinkInitialized = 0;
+static int sinkRun = 0;
+static ARSAL_Mutex_t sinkMutex;
+static ARSAL_Cond_t sinkCond;
+static ARSAL_Thread_t writerThread = NULL;
+
+static VIDEOSINK_Slot_t *slots = NULL;
+static int slotCount = 0;
+static int queueHead = 0; // first frame queued ; the frames being written are just before it
+static int queueCount = 0;
+static int writingCount = 0;
+static int waitIFrame = 0;
+static int readerClosed = 0; // the reader of sinkFd is gone, nothing more can be written
+static VIDEOSINK_Metrics_t sinkMetrics;
+static uint32_t nextFrameIndex = 0;
+static VIDEOSINK_FrameCallback_t frameCallback = NULL;
+static void *frameCustomData = NULL;
+
+static const uint32_t classSize[VIDEOSINK_CLASS_HEAP] = {VIDEOSINK_SMALL_BUFFER_SIZE, VIDEOSINK_LARGE_BUFFER_SIZE};
+static uint8_t *slabRegion = NULL;
+static size_t slabSize = 0;
+static uint8_t **freeBuffers[VIDEOSINK_CLASS_HEAP]; // stack of the free buffers of each class
+static int freeCount[VIDEOSINK_CLASS_HEAP];
+
+static uint8_t config[VIDEOSINK_CONFIG_MAX_SIZE];
+static uint32_t configSize = 0;
+static int configPending = 0;
+
+int VIDEOSINK_Init (int fd, int frameCount)
+{
+    int failed = 0;
+
+    if ((fd < 0) || (frameCount <= 0) || (sinkInitialized))
+    {
+        return -1;
+    }
+
+    slots = calloc(frameCount, sizeof(VIDEOSINK_Slot_t));
+    if (slots == NULL)
+    {
+        return -1;
+    }
+
+    if (VIDEOSINK_CreateSlab(frameCount) != 0)
+    {
+        failed = 1;
+    }
+
+    slotCount = frameCount;
+    sinkFd = fd;
+    queueHead = 0;
+    queueCount = 0;
+    writingCount = 0;
+    waitIFrame = 0;
+    readerClosed = 0;
+    nextFrameIndex = 0;
+    configSize = 0;
+    configPending = 0;
+    memset(&sinkMetrics, 0, sizeof(sinkMetrics));
+
+    if (!failed)
+    {
+        ARSAL_Mutex_Init(&sinkMutex);
+        ARSAL_Cond_Init(&sinkCond);
+        sinkRun = 1;
+
+        if (ARSAL_Thread_Create(&writerThread, VIDEOSINK_WriterRun, NULL) != 0)
+        {
+            ARSAL_PRINT(ARSAL_PRINT_ERROR, TAG, "Creation of writer thread failed.");
+            ARSAL_Cond_Destroy(&sinkCond);
+            ARSAL_Mutex_Destroy(&sinkMutex);
+            writerThread = NULL;
+            failed = 1;
+        }
+    }
+
+    if (failed)
+    {
+        VIDEOSINK_DeleteSlab();
+        free(slots);
+        slots = NULL;
+        slotCount = 0;
+        return -1;
+    }
+
+    sinkInitialized = 1;
+
+    return 0;
+}
+
+void VIDEOSINK_Destroy (void)
+{
+    int i = 0;
+
+    if (!sinkInitialized)
+    {
+        return;
+    }
+
+    ARSAL_Mutex_Lock(&sinkMutex);
+    sinkRun = 0;
+    ARSAL_Cond_Signal(&sinkCond);
+    ARSAL_Mutex_Unlock(&sinkMutex);
+
+    ARSAL_Thread_Join(writerThread, NULL);
+    ARSAL_Thread_Destroy(&writerThread);
+    writerThread = NULL;
+
+    sinkInitialized = 0;
+
+    ARSAL_Cond_Destroy(&sinkCond);
+    ARSAL_Mutex_Destroy(&sinkMutex);
+
+    // the writer has released every buffer it wrote or dropped ; release anything left before unmapping
+    for (i = 0; i < slotCount; i++)
+    {
+        VIDEOSINK_ReleaseBuffer(&(slots[i]));
+    }
+    VIDEOSINK_DeleteSlab();
+    free(slots);
+    slots = NULL;
+    slotCount = 0;
+    sinkFd = -1;
+}
+
+void VIDEOSINK_SetFrameCallback (VIDEOSINK_FrameCallback_t callback, void *customData)
+{
+    frameCallback = callback;
+    frameCustomData = customData;
+}
+
+int VIDEOSINK_SetConfig (const uint8_t *sps, uint32_t spsSize, const uint8_t *pps, uint32_t ppsSize)
+{
+    if ((!sinkInitialized) || (sps == NULL) || (pps == NULL) || (spsSize + ppsSize > VIDEOSINK_CONFIG_MAX_SIZE))
+    {
+        return -1;
+    }
+
+    ARSAL_Mutex_Lock(&sinkMutex);
+
+    memcpy(config, sps, spsSize);
+    memcpy(config + spsSize, pps, ppsSize);
+    configSize = spsSize + ppsSize;
+    configPending = 1;
+
+    ARSAL_Mutex_Unlock(&sinkMutex);
+
+    return 0;
+}
+
+int VIDEOSINK_PushFrame (const ARCONTROLLER_Frame_t *frame)
+{
+    VIDEOSINK_Slot_t *slot = NULL;
+    struct timespec receivedTime;
+    uint32_t frameIndex = 0;
+    int ret = 0;
+
+    if ((!sinkInitialized) || (frame == NULL))
+    {
+        return -1;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &receivedTime);
+
+    ARSAL_Mutex_Lock(&sinkMutex);
+
+    sinkMetrics.received++;
+    frameIndex = nextFrameIndex++;
+
+    if (readerClosed)
+    {
+        sinkMetrics.writeErrors++;
+        ret = -1;
+    }
+
+    if ((ret == 0) && (waitIFrame) && (!frame->isIFrame))
+    {
+        // the frames up to the next I-frame reference a dropped frame
+        sinkMetrics.droppedSkip++;
+        ret = -1;
+    }
+
+    if ((ret == 0) && (queueCount + writingCount >= slotCount))
+    {
+        if ((frame->isIFrame) && (queueCount > 0))
+        {
+            // the I-frame makes the queued frames useless to the decoder: replace them
+            sinkMetrics.flushed += queueCount;
+            VIDEOSINK_DropQueued();
+            waitIFrame = 1;
+        }
+        else
+        {
+            sinkMetrics.droppedFull++;
+            waitIFrame = 1;
+            ret = -1;
+        }
+    }
+
+    if (ret == 0)
+    {
+        slot = &(slots[(queueHead + queueCount) % slotCount]);
+
+        if (VIDEOSINK_AcquireBuffer(slot, frame->used) != 0)
+        {
+            sinkMetrics.droppedFull++;
+            waitIFrame = 1;
+            ret = -1;
+        }
+    }
+
+    if (ret == 0)
+    {
+        if (waitIFrame)
+        {
+            // resend the SPS and PPS with the I-frame the decoder restarts from
+            waitIFrame = 0;
+            configPending = (configSize > 0);
+        }
+
+        memcpy(slot->data, frame->data, frame->used);
+        slot->used = frame->used;
+        slot->isIFrame = frame->isIFrame;
+        slot->receivedTime = receivedTime;
+        slot->frameIndex = frameIndex;
+        queueCount++;
+
+        if (queueCount > sinkMetrics.maxDepth)
+        {
+            sinkMetrics.maxDepth = queueCount;
+        }
+
+        ARSAL_Cond_Signal(&sinkCond);
+    }
+    else if (frameCallback != NULL)
+    {
+        // only recorded, the frame is not parsed on the stream thread
+        frameCallback(frameIndex, NULL, frame->used, frame->isIFrame, &receivedTime, frameCustomData);
+    }
+
+    ARSAL_Mutex_Unlock(&sinkMutex);
+
+    return ret;
+}
+
+void VIDEOSINK_GetMetrics (VIDEOSINK_Metrics_t *metrics)
+{
+    if (metrics == NULL)
+    {
+        return;
+    }
+
+    if (!sinkInitialized)
+    {
+        memset(metrics, 0, sizeof(*metrics));
+        return;
+    }
+
+    ARSAL_Mutex_Lock(&sinkMutex);
+    *metrics = sinkMetrics;
+    metrics->depth = queueCount;
+    ARSAL_Mutex_Unlock(&sinkMutex);
+}
+
+/*****************************************
+ *
+ *             private implementation:
+ *
+ ****************************************/
+
+static void *VIDEOSINK_WriterRun (void *data)
+{
+    struct iovec iov[VIDEOSINK_MAX_BATCH + 1];
+    VIDEOSINK_Slot_t *slot = NULL;
+    uint8_t batchConfig[VIDEOSINK_CONFIG_MAX_SIZE];
+    struct timespec now;
+    int first = 0;
+    int frameCount = 0;
+    int iovCount = 0;
+    int latencyMs = 0;
+    int error = 0;
+    int i = 0;
+
+    ARSAL_Mutex_Lock(&sinkMutex);
+
+    while (1)
+    {
+        while ((sinkRun) && (queueCount == 0))
+        {
+            ARSAL_Cond_Wait(&sinkCond, &sinkMutex);
+        }
+
+        if (queueCount == 0)
+        {
+            // stopped and nothing left to write
+            break;
+        }
+
+        // take a batch ; its slots are not reused by VIDEOSINK_PushFrame() until writingCount is reset
+        frameCount = (queueCount < VIDEOSINK_MAX_BATCH) ? queueCount : VIDEOSINK_MAX_BATCH;
+        first = queueHead;
+        queueHead = (queueHead + frameCount) % slotCount;
+        queueCount -= frameCount;
+        writingCount = frameCount;
+
+        iovCount = 0;
+        if (configPending)
+        {
+            memcpy(batchConfig, config, configSize);
+            iov[iovCount].iov_base = batchConfig;
+            iov[iovCount].iov_len = configSize;
+            iovCount++;
+            configPending = 0;
+        }
+
+        for (i = 0; i < frameCount; i++)
+        {
+            iov[iovCount].iov_base = slots[(first + i) % slotCount].data;
+            iov[iovCount].iov_len = slots[(first + i) % slotCount].used;
+            iovCount++;
+        }
+
+        ARSAL_Mutex_Unlock(&sinkMutex);
+
+        error = VIDEOSINK_WriteAll(iov, iovCount);
+        clock_gettime(CLOCK_MONOTONIC, &now);
+
+        // the buffers of the batch are still owned by the writer
+        if (frameCallback != NULL)
+        {
+            for (i = 0; i < frameCount; i++)
+            {
+                slot = &(slots[(first + i) % slotCount]);
+                frameCallback(slot->frameIndex, slot->data, slot->used, slot->isIFrame, &(slot->receivedTime), frameCustomData);
+            }
+        }
+
+        ARSAL_Mutex_Lock(&sinkMutex);
+
+        if (error == 0)
+        {
+            for (i = 0; i < frameCount; i++)
+            {
+                latencyMs = ARSAL_Time_ComputeTimespecMsTimeDiff(&(slots[(first + i) % slotCount].receivedTime), &now);
+                sinkMetrics.lastLatencyMs = latencyMs;
+                sinkMetrics.totalLatencyMs += latencyMs;
+                if ((uint32_t)latencyMs > sinkMetrics.maxLatencyMs)
+                {
+                    sinkMetrics.maxLatencyMs = latencyMs;
+                }
+            }
+            sinkMetrics.written += frameCount;
+        }
+        else
+        {
+            sinkMetrics.writeErrors += frameCount;
+
+            if (error == EPIPE)
+            {
+                // the player has quit: drop the next frames too
+                ARSAL_PRINT(ARSAL_PRINT_WARNING, TAG, "Video reader closed, the next frames are dropped.");
+                readerClosed = 1;
+                sinkMetrics.writeErrors += queueCount;
+            }
+            else
+            {
+                // the batch may have been cut in the middle of a NAL unit: restart from the next I-frame, with the SPS and PPS
+                ARSAL_PRINT(ARSAL_PRINT_ERROR, TAG, "writev failed: %d, %s", error, strerror(error));
+                sinkMetrics.flushed += queueCount;
+                waitIFrame = 1;
+            }
+
+            // the queued frames reference the frames lost
+            VIDEOSINK_DropQueued();
+        }
+
+        for (i = 0; i < frameCount; i++)
+        {
+            VIDEOSINK_ReleaseBuffer(&(slots[(first + i) % slotCount]));
+        }
+        writingCount = 0;
+    }
+
+    ARSAL_Mutex_Unlock(&sinkMutex);
+
+    return NULL;
+}
+
+// must be called with sinkMutex locked ; release the frames queued, the frame callback only records them
+static void VIDEOSINK_DropQueued (void)
+{
+    VIDEOSINK_Slot_t *slot = NULL;
+    int i = 0;
+
+    for (i = 0; i < queueCount; i++)
+    {
+        slot = &(slots[(queueHead + i) % slotCount]);
+        if (frameCallback != NULL)
+        {
+            frameCallback(slot->frameIndex, NULL, slot->used, slot->isIFrame, &(slot->receivedTime), frameCustomData);
+        }
+        VIDEOSINK_ReleaseBuffer(slot);
+    }
+    queueHead = (queueHead + queueCount) % slotCount;
+    queueCount = 0;
+}
+
+// write the whole iovec, retrying on partial writes ; the errno of the failure, 0 if no error occurred
+static int VIDEOSINK_WriteAll (struct iovec *iov, int iovCount)
+{
+    ssize_t ret = 0;
+
+    while (iovCount > 0)
+    {
+        ret = writev(sinkFd, iov, iovCount);
+        if (ret < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return errno;
+        }
+
+        // skip what has been written
+        while ((iovCount > 0) && ((size_t)ret >= iov->iov_len))
+        {
+            ret -= iov->iov_len;
+            iov++;
+            iovCount--;
+        }
+        if (iovCount > 0)
+        {
+            iov->iov_base = (uint8_t *)iov->iov_base + ret;
+            iov->iov_len -= ret;
+        }
+    }
+
+    return 0;
+}
+
+// map the buffers of all the classes in one region and touch each page, so the stream thread never faults on them
+static int VIDEOSINK_CreateSlab (int frameCount)
+{
+    int bufferCount[VIDEOSINK_CLASS_HEAP] = {frameCount, VIDEOSINK_LARGE_BUFFER_COUNT};
+    long pageSize = sysconf(_SC_PAGESIZE);
+    uint8_t *buffer = NULL;
+    size_t offset = 0;
+    int hugePages = 1;
+    int bufferClass = 0;
+    int i = 0;
+
+    slabSize = 0;
+    for (bufferClass = 0; bufferClass < VIDEOSINK_CLASS_HEAP; bufferClass++)
+    {
+        slabSize += (size_t)bufferCount[bufferClass] * classSize[bufferClass];
+    }
+    slabSize = (slabSize + VIDEOSINK_HUGEPAGE_SIZE - 1) / VIDEOSINK_HUGEPAGE_SIZE * VIDEOSINK_HUGEPAGE_SIZE;
+
+#ifdef MAP_HUGETLB
+    slabRegion = mmap(NULL, slabSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+#else
+    slabRegion = MAP_FAILED;
+#endif
+    if (slabRegion == MAP_FAILED)
+    {
+        // no hugepage reserved: fall back to normal pages, transparent hugepages if enabled
+        hugePages = 0;
+        slabRegion = mmap(NULL, slabSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (slabRegion == MAP_FAILED)
+        {
+            ARSAL_PRINT(ARSAL_PRINT_ERROR, TAG, "mmap of %zu bytes failed: %d, %s", slabSize, errno, strerror(errno));
+            slabRegion = NULL;
+            return -1;
+        }
+#ifdef MADV_HUGEPAGE
+        madvise(slabRegion, slabSize, MADV_HUGEPAGE);
+#endif
+    }
+
+    for (offset = 0; offset < slabSize; offset += pageSize)
+    {
+        slabRegion[offset] = 0;
+    }
+
+    for (bufferClass = 0; bufferClass < VIDEOSINK_CLASS_HEAP; bufferClass++)
+    {
+        freeBuffers[bufferClass] = malloc(bufferCount[bufferClass] * sizeof(uint8_t *));
+        freeCount[bufferClass] = 0;
+        if (freeBuffers[bufferClass] == NULL)
+        {
+            VIDEOSINK_DeleteSlab();
+            return -1;
+        }
+    }
+
+    buffer = slabRegion;
+    for (bufferClass = 0; bufferClass < VIDEOSINK_CLASS_HEAP; bufferClass++)
+    {
+        for (i = 0; i < bufferCount[bufferClass]; i++)
+        {
+            freeBuffers[bufferClass][freeCount[bufferClass]++] = buffer;
+            buffer += classSize[bufferClass];
+        }
+    }
+
+    ARSAL_PRINT(ARSAL_PRINT_INFO, TAG, "%zu bytes of frame buffers on %s pages", slabSize, hugePages ? "huge" : "normal");
+
+    return 0;
+}
+
+static void VIDEOSINK_DeleteSlab (void)
+{
+    int bufferClass = 0;
+
+    for (bufferClass = 0; bufferClass < VIDEOSINK_CLASS_HEAP; bufferClass++)
+    {
+        free(freeBuffers[bufferClass]);
+        freeBuffers[bufferClass] = NULL;
+        freeCount[bufferClass] = 0;
+    }
+
+    if (slabRegion != NULL)
+    {
+        munmap(slabRegion, slabSize);
+        slabRegion = NULL;
+    }
+    slabSize = 0;
+}
+
+// must be called with sinkMutex locked ; takes the smallest class holding size, a larger one if it is exhausted
+static int VIDEOSINK_AcquireBuffer (VIDEOSINK_Slot_t *slot, uint32_t size)
+{
+    int bufferClass = 0;
+
+    for (bufferClass = 0; bufferClass < VIDEOSINK_CLASS_HEAP; bufferClass++)
+    {
+        if ((size <= classSize[bufferClass]) && (freeCount[bufferClass] > 0))
+        {
+            slot->data = freeBuffers[bufferClass][--freeCount[bufferClass]];
+            slot->bufferClass = bufferClass;
+            return 0;
+        }
+    }
+
+    // larger than VIDEOSINK_LARGE_BUFFER_SIZE or more I-frames queued than large buffers
+    slot->data = malloc(size);
+    if (slot->data == NULL)
+    {
+        return -1;
+    }
+    slot->bufferClass = VIDEOSINK_CLASS_HEAP;
+    sinkMetrics.heapAllocs++;
+
+    return 0;
+}
+
+// must be called with sinkMutex locked
+static void VIDEOSINK_ReleaseBuffer (VIDEOSINK_Slot_t *slot)
+{
+    if (slot->data == NULL)
+    {
+        return;
+    }
+
+    if (slot->bufferClass == VIDEOSINK_CLASS_HEAP)
+    {
+        free(slot->data);
+    }
+    else
+    {
+        freeBuffers[slot->bufferClass][freeCount[slot->bufferClass]++] = slot->data;
+    }
+    slot->data = NULL;
+}
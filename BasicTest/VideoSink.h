@@ -0,0 +1,103 @@
+/**
+ * @file VideoSink.h
+ * @brief Video sink writing the H264 stream to a file descriptor from its own thread
+ * @date 19/10/2026
+ */
+
+#ifndef _VIDEOSINK_H_
+#define _VIDEOSINK_H_
+
+#include <stdint.h>
+#include <time.h>
+
+#include <libARController/ARController.h>
+
+#define VIDEOSINK_MAX_BATCH 16 /**< Maximum number of frames written by one writev() */
+#define VIDEOSINK_SMALL_BUFFER_SIZE (64 * 1024) /**< Size of the buffers of the P-frames, one per queued frame */
+#define VIDEOSINK_LARGE_BUFFER_SIZE (256 * 1024) /**< Size of the buffers of the I-frames */
+#define VIDEOSINK_LARGE_BUFFER_COUNT 4 /**< Number of I-frame buffers ; an I-frame arrives every 30 frames or so */
+
+/**
+ * @brief Counters of the video sink
+ */
+typedef struct
+{
+    uint32_t received; /**< Number of frames given to VIDEOSINK_PushFrame() */
+    uint32_t written; /**< Number of frames written */
+    uint32_t droppedFull; /**< Number of frames dropped because the queue was full */
+    uint32_t droppedSkip; /**< Number of frames dropped while waiting for an I-frame */
+    uint32_t flushed; /**< Number of queued frames dropped by an I-frame arriving on a full queue */
+    uint32_t writeErrors; /**< Number of frames dropped because they could not be written ; once the reader has closed the FIFO, all the frames received */
+    uint32_t heapAllocs; /**< Number of frames copied in a malloc() buffer because no preallocated buffer could hold them */
+    uint32_t depth; /**< Number of frames currently queued */
+    uint32_t maxDepth; /**< Highest number of frames queued at the same time */
+    uint32_t lastLatencyMs; /**< Time between the reception and the end of the write of the last frame written */
+    uint32_t maxLatencyMs; /**< Highest latency */
+    uint64_t totalLatencyMs; /**< Sum of the latencies, divide by written for the mean */
+} VIDEOSINK_Metrics_t;
+
+/**
+ * @brief Callback called once for each frame received
+ * @note The frames taken from the queue are given with their data by the writer thread, once written ; the callback delays the next writes.
+ * The frames dropped before being written are given without data, with the lock of the sink held, from VIDEOSINK_PushFrame() or the writer thread:
+ * the callback must only record them. The frames do not come in the order of frameIndex.
+ * @param[in] frameIndex Index of the frame since VIDEOSINK_Init()
+ * @param[in] data Frame data, only valid during the call ; NULL if the frame has been dropped
+ * @param[in] size Frame size
+ * @param[in] isIFrame '1' if the frame is an I-frame
+ * @param[in] receivedTime CLOCK_MONOTONIC time of VIDEOSINK_PushFrame()
+ * @param[in] customData Data given to VIDEOSINK_SetFrameCallback()
+ */
+typedef void (*VIDEOSINK_FrameCallback_t) (uint32_t frameIndex, const uint8_t *data, uint32_t size, int isIFrame, const struct timespec *receivedTime, void *customData);
+
+/**
+ * @brief Initialize the video sink and start its writer thread
+ * @post VIDEOSINK_Destroy() must be called
+ * @param[in] fd File descriptor the stream is written to, typically the FIFO read by the player
+ * @param[in] frameCount Number of frames which can be queued ; the frame buffers are allocated and prefaulted here
+ * @return 0 if no error occurred
+ */
+int VIDEOSINK_Init (int fd, int frameCount);
+
+/**
+ * @brief Stop the writer thread once the queued frames are written and free the frames
+ * @note The file descriptor is not closed
+ */
+void VIDEOSINK_Destroy (void);
+
+/**
+ * @brief Set the callback called for each frame received
+ * @note Must be called before the first frame is pushed
+ * @param[in] callback The callback ; NULL to remove it
+ * @param[in] customData Data given to the callback
+ */
+void VIDEOSINK_SetFrameCallback (VIDEOSINK_FrameCallback_t callback, void *customData);
+
+/**
+ * @brief Give the SPS and PPS of the stream, written before the next frame and after each skip to an I-frame
+ * @note Called from decoderConfigCallback
+ * @param[in] sps SPS NAL unit
+ * @param[in] spsSize Size of the SPS
+ * @param[in] pps PPS NAL unit
+ * @param[in] ppsSize Size of the PPS
+ * @return 0 if no error occurred
+ */
+int VIDEOSINK_SetConfig (const uint8_t *sps, uint32_t spsSize, const uint8_t *pps, uint32_t ppsSize);
+
+/**
+ * @brief Queue a frame
+ * @note Called from didReceiveFrameCallback ; never blocks on the writer. The frame is copied, it can be released once the function returns.
+ * When the queue is full the frame is dropped and the following frames are dropped up to the next I-frame ;
+ * an I-frame arriving on a full queue replaces the queued frames.
+ * @param[in] frame The frame received
+ * @return 0 if the frame is queued, -1 if it is dropped
+ */
+int VIDEOSINK_PushFrame (const ARCONTROLLER_Frame_t *frame);
+
+/**
+ * @brief Get the counters of the video sink
+ * @param[out] metrics The counters
+ */
+void VIDEOSINK_GetMetrics (VIDEOSINK_Metrics_t *metrics);
+
+#endif /* _VIDEOSINK_H_ */